@@ -0,0 +1,69 @@
+# Embed every shader in SHADER_DIR into OUTPUT, a C source of the `EMBEDDED_SHADERS`
+# table declared in style/shader.h, so that shaders are looked up with no file I/O.
+# The `#version` line of a shader is kept apart from its body, so that `#define`s of
+# a variant can be inserted between them; defines of every variant are generated too.
+#   cmake -DSHADER_DIR=<dir> -DOUTPUT=<file> -P embed-shaders.cmake
+
+# Flags of `enum SHADER_VARIANT`, in order of their bits.
+set(VARIANT_FLAGS XGL_VARIANT_AA XGL_VARIANT_INSTANCED)
+
+# Quote `text` as a C string literal, split at newlines.
+function(c_string text out)
+  string(REPLACE "\\" "\\\\" text "${text}")
+  string(REPLACE "\"" "\\\"" text "${text}")
+  string(REPLACE "\t" "\\t" text "${text}")
+  string(REPLACE "\r" "" text "${text}")
+  string(REPLACE "\n" "\\n\"\n    \"" text "${text}")
+  set(${out} "\"${text}\"" PARENT_SCOPE)
+endfunction()
+
+file(GLOB SHADER_FILES LIST_DIRECTORIES false "${SHADER_DIR}/*.glsl")
+list(SORT SHADER_FILES)
+
+set(SOURCE "// Generated by cmake/embed-shaders.cmake from shader/, do not edit.\n\n")
+string(APPEND SOURCE "#include \"shader.h\"\n\n")
+string(APPEND SOURCE "const EmbeddedShader EMBEDDED_SHADERS[] = {\n")
+set(N_SHADERS 0)
+foreach(SHADER_FILE ${SHADER_FILES})
+  get_filename_component(NAME "${SHADER_FILE}" NAME)
+  file(READ "${SHADER_FILE}" TEXT)
+  set(VERSION "")
+  string(FIND "${TEXT}" "#version" VERSION_AT)
+  if(VERSION_AT EQUAL 0)
+    string(FIND "${TEXT}" "\n" LINE_END)
+    math(EXPR BODY_AT "${LINE_END} + 1")
+    string(SUBSTRING "${TEXT}" 0 ${BODY_AT} VERSION)
+    string(SUBSTRING "${TEXT}" ${BODY_AT} -1 TEXT)
+  endif()
+  c_string("${VERSION}" VERSION)
+  c_string("${TEXT}" TEXT)
+  string(APPEND SOURCE "  {\n    \"${NAME}\",\n    ${VERSION},\n    ${TEXT},\n  },\n")
+  math(EXPR N_SHADERS "${N_SHADERS} + 1")
+endforeach()
+string(APPEND SOURCE "};\n\nconst uint32_t N_EMBEDDED_SHADERS = ${N_SHADERS};\n\n")
+
+list(LENGTH VARIANT_FLAGS N_FLAGS)
+math(EXPR N_VARIANTS "(1 << ${N_FLAGS}) - 1")
+string(APPEND SOURCE "const char * const SHADER_VARIANT_DEFINES[SHADER_VARIANTS] = {\n")
+foreach(VARIANT RANGE ${N_VARIANTS})
+  set(DEFINES "")
+  set(BIT 0)
+  foreach(FLAG ${VARIANT_FLAGS})
+    math(EXPR SET "(${VARIANT} >> ${BIT}) & 1")
+    if(SET)
+      string(APPEND DEFINES "#define ${FLAG} 1\\n")
+    endif()
+    math(EXPR BIT "${BIT} + 1")
+  endforeach()
+  string(APPEND SOURCE "  \"${DEFINES}\",\n")
+endforeach()
+string(APPEND SOURCE "};\n")
+
+# Only touch OUTPUT when it changes, so that dependents are not rebuilt for nothing.
+set(OLD_SOURCE "")
+if(EXISTS "${OUTPUT}")
+  file(READ "${OUTPUT}" OLD_SOURCE)
+endif()
+if(NOT OLD_SOURCE STREQUAL SOURCE)
+  file(WRITE "${OUTPUT}" "${SOURCE}")
+endif()
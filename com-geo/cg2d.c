@@ -9,6 +9,7 @@
 
 #include "cg2d.h"
 #include "definition.h"
+#include "trace.h"
 #include "xgl-object.h"
 #include <float.h>
 #include <math.h>
@@ -287,6 +288,7 @@ void legalizeTriangulation(struct Triangle * const triangles, struct SharedEdge
     (triangle)->indices[2] = ear_vni->right;                            \
   } while (false)
 Array *xglEarClippingTriangulate2D(const Array *vert_array, const Allocator *allocator) {
+  TRACE_ZONE("xglEarClippingTriangulate2D");
   const int count = (int) Array_length(vert_array);
   const XGLCoord * const vertices = Array_get(vert_array, 0);
 
@@ -373,6 +375,7 @@ Array *xglEarClippingTriangulate2D(const Array *vert_array, const Allocator *all
     (triangle)->indices[2] = (i + 1) % (n_triangles - cycle);                            \
   } while (false)
 Array *xglRadialTriangulation2D(const Array *vert_array, bool cycle, const Allocator *allocator) {
+  TRACE_ZONE("xglRadialTriangulation2D");
   const int n_verts = (int) Array_length(vert_array);
   const XGLCoord * const vertices = Array_get(vert_array, 0);
   if (n_verts < 4) {
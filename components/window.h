@@ -23,6 +23,14 @@ struct WinMetaInfo {
   void *handle;
 };
 
+// Counters of the event loop: how often it woke up, and how many of those wakes
+// published a frame. An idle window should have few wakes and no idle frames.
+struct LoopStats {
+  uint64_t wakes;
+  uint64_t frames;
+  uint64_t idleFrames;
+};
+
 typedef struct Dialog {
   struct WinMetaInfo info;
   const Allocator *allocator;
@@ -37,6 +45,15 @@ typedef struct MainWindow {
   Widget *leftBar;
   Widget *central;
   Array *drawTaskList;  // Array<DrawTask>
+  uint64_t drawTaskVersion;  // changed whenever drawTaskList is changed
+  struct DrawPasses *drawPasses;
+  struct BackBuffer *backBuffer;
+  struct RenderThread *renderThread;
+  struct PerfHud *hud;
+  Array *timers;  // Array<IdeTimer>
+  uint32_t nextTimerId;
+  struct MPSCQueue *uiCalls;  // of calls from other threads, run by `ideWaitEvents`
+  struct LoopStats loopStats;
   float viewport[4];
 } IdeWindow;
 
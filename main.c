@@ -1,11 +1,54 @@
+#include "reload.h"
 #include "runtime.h"
 #include "shader.h"
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
+// Animation timer of the progress bar, a dynamic task.
+static void animateProgress(IdeWindow *window, void *arg) {
+  DrawTask *progress = arg;
+  const float bar_width = 600.0f * (float) fmod(glfwGetTime() / 5.0, 1.0);
+  XGLVertex *bar = xglMapDynamicVertices(progress);
+  GLuint *indices = xglMapDynamicIndices(progress);
+  // frames in flight still read the region; the next tick catches up
+  if (!bar || !indices) { return; }
+  const GLfloat corners[4][2] = {
+    {100, 540}, {100 + bar_width, 540}, {100 + bar_width, 560}, {100, 560},
+  };
+  for (int i = 0; i < 4; i++) {
+    bar[i].coord[AXIS_X] = corners[i][AXIS_X];
+    bar[i].coord[AXIS_Y] = corners[i][AXIS_Y];
+    rgba2XGLColor8(0x3399FFFF, &bar[i].color);
+  }
+  const GLuint quad[6] = {0, 1, 2, 0, 2, 3};
+  memcpy(indices, quad, sizeof(quad));
+  const GLfloat bounds[4] = {100, 540, 100 + bar_width, 560};
+  xglCommitDynamicTask(progress, 6, bounds);
+}
+
 int main(int argc, char *argv[]) {
-  const Allocator * const allocator = &STDAllocator;
+  // Allocations are counted for the performance HUD.
+  const Allocator * const allocator = &CountingAllocator;
+  TRACE_THREAD_NAME("main");
+  TRACE_BEGIN("startup");
+
+  // Analytic anti-aliasing by default; 4x MSAA with `--msaa`.
+  // `--trace <file>` writes zones as Chrome trace-event JSON at exit.
+  // `--watch-shaders <dir>` reloads built-in shaders from files of `dir` as they change.
+  enum XGL_AA_MODE aa_mode = AA_ANALYTIC;
+  const char *trace_path = nullptr;
+  const char *shader_dir = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--msaa") == 0) { aa_mode = AA_MSAA; }
+    if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) { trace_path = argv[++i]; }
+    if (strcmp(argv[i], "--watch-shaders") == 0 && i + 1 < argc) { shader_dir = argv[++i]; }
+  }
+  xglSetAntiAliasMode(aa_mode);
 
   if (!glfwInit()) { return -1; }
   rt_message("Using GLFW Version: %d.%d", GLFW_VERSION_MAJOR, GLFW_VERSION_MINOR);
@@ -14,14 +57,15 @@ int main(int argc, char *argv[]) {
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
   glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
-  glfwWindowHint(GLFW_SAMPLES, 4);
+  glfwWindowHint(GLFW_SAMPLES, aa_mode == AA_MSAA ? 4 : 0);
   glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
   glfwWindowHint(GLFW_DOUBLEBUFFER, GLFW_TRUE);
 
   int width = 1000, height = 800;
   GLFWmonitor *monitor = NULL;
   if (argc == -1) { monitor = switchMonitor(0, &width, &height); }
-  GLFWwindow *handle = glfwCreateWindow(width, height, "glfwWindow title", monitor, NULL);
+  const char * const title = "glfwWindow title";
+  GLFWwindow *handle = glfwCreateWindow(width, height, title, monitor, NULL);
   if (!handle) {
     glfwTerminate();
     return -1;
@@ -29,6 +73,7 @@ int main(int argc, char *argv[]) {
   glfwSwapInterval(1);
   glfwSetWindowSizeCallback(handle, ideSetWindowSize);
   glfwSetWindowRefreshCallback(handle, ideWindowRefreshCallback);
+  glfwSetKeyCallback(handle, ideKeyCallback);
   glfwMakeContextCurrent(handle);
 
   int status = gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
@@ -46,22 +91,19 @@ int main(int argc, char *argv[]) {
   }
 
   IdeWindow *mainWindow = ideCreateWindow(handle, allocator);
+  if (aa_mode == AA_MSAA) { glEnable(GL_MULTISAMPLE); }
+  xglSetStrokeWidth(2);
 
-  // shader program
-  GLuint vertexShader = compileShader("shader/vert-default.glsl", GL_VERTEX_SHADER, allocator);
-  GLuint fragmentShader = compileShader("shader/frag-default.glsl", GL_FRAGMENT_SHADER, allocator);
-  GLuint shaderProgram = glCreateProgram();
-  glAttachShader(shaderProgram, vertexShader);
-  glAttachShader(shaderProgram, fragmentShader);
-  glLinkProgram(shaderProgram);
-  glGetProgramiv(shaderProgram, GL_LINK_STATUS, &status);
-  if (!status) {
-    GLchar infoLog[512];
-    glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-    rt_error("Failed to link shader program: \n%s", infoLog);
-  }
-  glDeleteShader(vertexShader);
-  glDeleteShader(fragmentShader);
+  // shader program, from the program binary cache after the first run; otherwise built by
+  // driver threads while first frames are shown without the tasks using it
+  setProgramCacheDir("shader-cache");
+  const uint32_t variant = aa_mode == AA_ANALYTIC ? SV_AA : 0;
+  GLuint shaderProgram =
+      linkEmbeddedProgramAsync("vert-default.glsl", "frag-default.glsl", variant, allocator);
+  GLuint rectProgram = linkEmbeddedProgramAsync("vert-rect.glsl", "frag-rect.glsl",
+                                                variant | SV_INSTANCED, allocator);
+  ideWatchProgram(shaderProgram, "vert-default.glsl", "frag-default.glsl", variant);
+  ideWatchProgram(rectProgram, "vert-rect.glsl", "frag-rect.glsl", variant | SV_INSTANCED);
 
   DrawTask *task;
 
@@ -128,17 +170,61 @@ int main(int argc, char *argv[]) {
   allocator->free(task);
   releaseArray(line_array);
 
-  glLineWidth(2);
-  glEnable(GL_MULTISAMPLE);
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  // progress bar, rewritten every frame.
+  task = xglCreateDynamicTask(TT_SOLID_AREA, 4, 6, 1, allocator);
+  xglBindShaderProgram(task, shaderProgram);
+  ideWindowAddTasks(mainWindow, task, 1);
+  allocator->free(task);
+
+  // top bar with tabs
+  Array *rect_array = Array_new(sizeof(XGLRect), allocator);
+  XGLRect top_bar = {.rect = {0, 0, 1000, 32}};
+  rgba2XGLColor8(0x2B2D30FF, &top_bar.fill);
+  Array_append(rect_array, &top_bar, 1);
+  for (int i = 0; i < 4; i++) {
+    XGLRect tab = {
+      .rect = {8.0f + 128.0f * (float) i, 4, 120, 28},
+      .radii = {6, 6, 0, 0},
+      .border_width = 1.0f,
+    };
+    rgba2XGLColor8(i == 0 ? 0x1E1F22FF : 0x3C3F41FF, &tab.fill);
+    rgba2XGLColor8(0x5E6063FF, &tab.border);
+    Array_append(rect_array, &tab, 1);
+  }
+  task = xglCreateRects(rect_array, 2, allocator);
+  xglBindShaderProgram(task, rectProgram);
+  ideWindowAddTasks(mainWindow, task, 1);
+  allocator->free(task);
+  releaseArray(rect_array);
+
+  // performance HUD, toggled by F3
+  ideCreateHud(mainWindow, title, rectProgram, shaderProgram);
+
+  DrawTask *progress = ideWindowGetTask(mainWindow, 3);
+
+  xglBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  // GL is only used by the render thread from now on.
+  ideStartRenderThread(mainWindow);
+  if (shader_dir) { ideWatchShaders(mainWindow, shader_dir); }
+  ideAddTimer(mainWindow, 0, 1.0 / 60, animateProgress, progress);
+  TRACE_END();
   while (!glfwWindowShouldClose(handle)) {
+    ideWaitEvents(mainWindow);
     ideProcessInput(handle);
-    ideDrawUI(mainWindow);
-    glfwPollEvents();
+    idePublishFrame(mainWindow);
   }
+  const struct LoopStats *stats = &mainWindow->loopStats;
+  rt_message("event loop: %llu wakes, %llu frames, %llu idle frames",
+             (unsigned long long) stats->wakes, (unsigned long long) stats->frames,
+             (unsigned long long) stats->idleFrames);
+  XGLGpuStats gpu_stats;
+  xglGpuTimerStats(&gpu_stats);
+  rt_message("gpu frame time: %.3f ms mean, %.3f ms p95, %.3f ms p99 over %u frames",
+             gpu_stats.frame.mean, gpu_stats.frame.p95, gpu_stats.frame.p99, gpu_stats.history);
 
+  ideUnwatchShaders();
   ideDestroyWindow(mainWindow);
   glfwTerminate();
+  if (trace_path && ideTraceDump(trace_path)) { rt_message("Trace written to '%s'", trace_path); }
   return 0;
 }
@@ -9,6 +9,39 @@
 
 #include "allocator.h"
 #include <malloc.h>
+#include <stdatomic.h>
 
 const Allocator STDAllocator = {
   .malloc = malloc, .realloc = realloc, .calloc = calloc, .free = free};
+
+static _Atomic uint64_t ALLOCATIONS = 0;
+static _Atomic uint64_t FREES = 0;
+
+static void *countingMalloc(const size_t size) {
+  atomic_fetch_add_explicit(&ALLOCATIONS, 1, memory_order_relaxed);
+  return malloc(size);
+}
+
+static void *countingRealloc(void *ptr, const size_t size) {
+  atomic_fetch_add_explicit(&ALLOCATIONS, 1, memory_order_relaxed);
+  return realloc(ptr, size);
+}
+
+static void *countingCalloc(const size_t count, const size_t size) {
+  atomic_fetch_add_explicit(&ALLOCATIONS, 1, memory_order_relaxed);
+  return calloc(count, size);
+}
+
+static void countingFree(void *ptr) {
+  if (ptr) { atomic_fetch_add_explicit(&FREES, 1, memory_order_relaxed); }
+  free(ptr);
+}
+
+const Allocator CountingAllocator = {
+  .malloc = countingMalloc, .realloc = countingRealloc, .calloc = countingCalloc,
+  .free = countingFree};
+
+void CountingAllocator_stats(AllocatorStats *stats) {
+  stats->allocations = atomic_load_explicit(&ALLOCATIONS, memory_order_relaxed);
+  stats->frees = atomic_load_explicit(&FREES, memory_order_relaxed);
+}
@@ -11,6 +11,7 @@
 #define XIDE_ALLOCATOR_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct {
   void *(* const malloc)(size_t size);
@@ -24,4 +25,14 @@ typedef struct {
 
 extern const Allocator STDAllocator;
 
+// Same as `STDAllocator`, and counts calls of every thread, for profiling.
+extern const Allocator CountingAllocator;
+
+typedef struct AllocatorStats {
+  uint64_t allocations;  // malloc, calloc and realloc
+  uint64_t frees;
+} AllocatorStats;
+
+void CountingAllocator_stats(AllocatorStats *stats);
+
 #endif  // XIDE_ALLOCATOR_H
@@ -7,17 +7,29 @@
  * Copyright (c) 2024 Yaokai Liu. All rights reserved.
  **/
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE  // for mremap
+#endif
+
 #include "array.h"
 #include "allocator.h"
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#if defined(__linux__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
 
 struct Array {
   const Allocator *allocator;
   uint32_t alloc_len;
   uint32_t ele_size;
   uint32_t used_len;
+  uint8_t storage;  // enum ARRAY_STORAGE
   void *elements;
 };
 
@@ -25,6 +37,73 @@ const size_t sizeof_array = sizeof(Array);
 
 #define ALLOC_LEN 32
 
+enum ARRAY_STORAGE {
+  // elements from `allocator`, grown by `realloc`.
+  AS_HEAP = 0,
+  // elements in anonymous mapping, grown by `mremap` without copy.
+  AS_MAPPED = 1,
+  // elements are a read-only private mapping of a file.
+  AS_FILE = 2,
+};
+
+#if defined(__linux__)
+static size_t pageRound(const size_t size) {
+  const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+  return (size + page - 1) / page * page;
+}
+#endif
+
+// Make room for at least `length` elements. Return false if storage can not grow.
+static bool growElements(Array * const array, const uint32_t length) {
+  switch (array->storage) {
+#if defined(__linux__)
+    case AS_MAPPED: {
+      // Double at least, so that appending one by one is not one syscall per page.
+      uint64_t new_len = (uint64_t) array->alloc_len * 2;
+      if (new_len < length) { new_len = length; }
+      if (new_len < pageRound(1) / array->ele_size) { new_len = pageRound(1) / array->ele_size; }
+      if (new_len > UINT32_MAX) { new_len = UINT32_MAX; }
+      const size_t old_size = pageRound((size_t) array->alloc_len * array->ele_size);
+      const size_t new_size = pageRound((size_t) new_len * array->ele_size);
+      void *p = nullptr;
+      if (array->elements) {
+        p = mremap(array->elements, old_size, new_size, MREMAP_MAYMOVE);
+      } else {
+        p = mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      }
+      if (p == MAP_FAILED) { return false; }
+      array->elements = p;
+      array->alloc_len = (uint32_t) new_len;
+      return true;
+    }
+#endif
+    case AS_FILE: return false;
+    default: {
+      void *p = array->allocator->realloc(array->elements, (size_t) length * array->ele_size);
+      if (!p) { return false; }
+      array->elements = p;
+      array->alloc_len = length;
+      return true;
+    }
+  }
+}
+
+static void releaseElements(Array * const array) {
+  if (!array->elements) { return; }
+  switch (array->storage) {
+#if defined(__linux__)
+    case AS_MAPPED:
+    case AS_FILE: {
+      munmap(array->elements, pageRound((size_t) array->alloc_len * array->ele_size));
+      break;
+    }
+#endif
+    default: {
+      array->allocator->free(array->elements);
+    }
+  }
+}
+
 Array *Array_new(const uint32_t ele_size, const Allocator * const allocator) {
   if (ele_size == 0) { return nullptr; }
   Array *array = allocator->calloc(1, sizeof(struct Array));
@@ -38,9 +117,61 @@ uint32_t Array_init(Array *array, const uint32_t ele_size, const Allocator *allo
   array->elements = nullptr;
   array->alloc_len = 0;
   array->used_len = 0;
+  array->storage = AS_HEAP;
   return ele_size;
 }
 
+Array *Array_new_mapped(const uint32_t ele_size, const Allocator * const allocator) {
+  Array *array = Array_new(ele_size, allocator);
+#if defined(__linux__)
+  if (array) { array->storage = AS_MAPPED; }
+#endif
+  return array;
+}
+
+Array *Array_map_file(const char *path, const uint32_t ele_size,
+                      const Allocator * const allocator) {
+  if (ele_size == 0) { return nullptr; }
+#if defined(__linux__)
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) { return nullptr; }
+  struct stat st = {};
+  if (fstat(fd, &st) != 0 || (uint64_t) st.st_size / ele_size > UINT32_MAX) {
+    close(fd);
+    return nullptr;
+  }
+  const uint32_t count = (uint32_t) ((size_t) st.st_size / ele_size);
+  void *elements = nullptr;
+  if (count) {
+    elements = mmap(nullptr, (size_t) count * ele_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (elements == MAP_FAILED) {
+      close(fd);
+      return nullptr;
+    }
+  }
+  close(fd);
+  Array *array = Array_new(ele_size, allocator);
+  array->storage = AS_FILE;
+  array->elements = elements;
+  array->alloc_len = count;
+  array->used_len = count;
+  return array;
+#else
+  FILE *file = NULL;
+  if (fopen_s(&file, path, "rb") != 0) { return nullptr; }
+  fseek(file, 0, SEEK_END);
+  const long length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  Array *array = Array_new(ele_size, allocator);
+  const uint32_t count = (uint32_t) (length / ele_size);
+  if (count && growElements(array, count)) {
+    array->used_len = (uint32_t) fread(array->elements, ele_size, count, file);
+  }
+  fclose(file);
+  return array;
+#endif
+}
+
 inline uint32_t Array_length(const Array *array) {
   return array->used_len;
 }
@@ -53,10 +184,7 @@ inline void *Array_get(const Array *array, uint32_t index) {
 uint32_t Array_append(Array *array, const void *elements, const uint32_t count) {
   if (array->used_len + count >= array->alloc_len) {
     uint32_t length = ((array->used_len + count) / ALLOC_LEN + 1) * ALLOC_LEN;
-    void *p = array->allocator->realloc(array->elements, length * array->ele_size);
-    if (!p) { return -1; }
-    array->elements = p;
-    array->alloc_len = length;
+    if (!growElements(array, length)) { return -1; }
   }
   void *dest = (char *) array->elements + array->ele_size * array->used_len;
   memcpy(dest, elements, count * array->ele_size);
@@ -64,6 +192,30 @@ uint32_t Array_append(Array *array, const void *elements, const uint32_t count)
   return count;
 }
 
+uint32_t Array_insert(Array *array, const uint32_t index, const void *elements,
+                      const uint32_t count) {
+  if (index > array->used_len) { return -1; }
+  if (array->used_len + count >= array->alloc_len) {
+    uint32_t length = ((array->used_len + count) / ALLOC_LEN + 1) * ALLOC_LEN;
+    if (!growElements(array, length)) { return -1; }
+  }
+  char *dest = (char *) array->elements + array->ele_size * index;
+  memmove(dest + array->ele_size * count, dest, array->ele_size * (array->used_len - index));
+  memcpy(dest, elements, count * array->ele_size);
+  array->used_len += count;
+  return count;
+}
+
+uint32_t Array_remove(Array *array, const uint32_t index, uint32_t count) {
+  if (index >= array->used_len || array->storage == AS_FILE) { return 0; }
+  if (count > array->used_len - index) { count = array->used_len - index; }
+  char *dest = (char *) array->elements + array->ele_size * index;
+  const uint32_t n_tail = array->used_len - index - count;
+  memmove(dest, dest + array->ele_size * count, array->ele_size * n_tail);
+  array->used_len -= count;
+  return count;
+}
+
 bool Array_any(const Array *array, bool (*fn_judgment)(void *)) {
   bool judge = false;
   for (uint32_t i = 0; i < array->used_len; i++) {
@@ -105,6 +257,304 @@ __deduplicate_find_duplicated:;
   return filtered_array;
 }
 
+struct Chunking {
+  const Array *array;
+  uint32_t n_chunks;
+  uint32_t chunk_len;
+};
+
+static void splitChunks(struct Chunking * const chunking, const Array * const array,
+                        const WorkerPool * const pool) {
+  const uint32_t n_threads = WorkerPool_size(pool) + 1;
+  uint32_t n_chunks = array->used_len / ARRAY_PARALLEL_GRAIN;
+  // A few chunks per thread, so a slow chunk does not hold up the others.
+  if (n_chunks > n_threads * 4) { n_chunks = n_threads * 4; }
+  if (n_chunks == 0) { n_chunks = 1; }
+  chunking->array = array;
+  chunking->n_chunks = n_chunks;
+  chunking->chunk_len = (array->used_len + n_chunks - 1) / n_chunks;
+}
+
+#define chunk_begin(_chunking, _index) ((_index) * (_chunking)->chunk_len)
+#define chunk_end(_chunking, _index)                                    \
+  ((_index) + 1 == (_chunking)->n_chunks ? (_chunking)->array->used_len \
+                                         : ((_index) + 1) * (_chunking)->chunk_len)
+#define element_at(_array, _index) \
+  ((char *) (_array)->elements + (size_t) (_index) * (_array)->ele_size)
+
+struct MapJob {
+  struct Chunking chunking;
+  Array *mapped;
+  void (*fn_map)(const void *, void *);
+};
+
+static void mapChunk(const uint32_t index, void *arg) {
+  const struct MapJob * const job = arg;
+  const Array * const origin = job->chunking.array;
+  for (uint32_t i = chunk_begin(&job->chunking, index); i < chunk_end(&job->chunking, index); i++) {
+    job->fn_map(element_at(origin, i), element_at(job->mapped, i));
+  }
+}
+
+Array *Array_parallel_map(const Array *origin_array, const uint32_t ele_size,
+                          void (*fn_map)(const void *, void *), WorkerPool *pool) {
+  Array *mapped = Array_new(ele_size, origin_array->allocator);
+  if (!mapped) { return nullptr; }
+  const uint32_t count = origin_array->used_len;
+  if (count == 0) { return mapped; }
+  mapped->elements = origin_array->allocator->malloc((size_t) count * ele_size);
+  if (!mapped->elements) {
+    Array_destroy(mapped);
+    return nullptr;
+  }
+  mapped->alloc_len = count;
+  mapped->used_len = count;
+  struct MapJob job = {.mapped = mapped, .fn_map = fn_map};
+  splitChunks(&job.chunking, origin_array, pool);
+  WorkerPool_run(pool, job.chunking.n_chunks, mapChunk, &job);
+  return mapped;
+}
+
+struct FilterJob {
+  struct Chunking chunking;
+  Array *outputs;  // Array[n_chunks]
+  bool (*fn_judgment)(const void *);
+};
+
+static void filterChunk(const uint32_t index, void *arg) {
+  const struct FilterJob * const job = arg;
+  const Array * const origin = job->chunking.array;
+  Array * const output = &job->outputs[index];
+  for (uint32_t i = chunk_begin(&job->chunking, index); i < chunk_end(&job->chunking, index); i++) {
+    const void *ele = element_at(origin, i);
+    if (job->fn_judgment(ele)) { Array_append(output, ele, 1); }
+  }
+}
+
+Array *Array_parallel_filter(const Array *origin_array, bool (*fn_judgment)(const void *),
+                             WorkerPool *pool) {
+  const Allocator * const allocator = origin_array->allocator;
+  struct FilterJob job = {.fn_judgment = fn_judgment};
+  splitChunks(&job.chunking, origin_array, pool);
+  job.outputs = allocator->calloc(job.chunking.n_chunks, sizeof(Array));
+  if (!job.outputs) { return nullptr; }
+  for (uint32_t i = 0; i < job.chunking.n_chunks; i++) {
+    Array_init(&job.outputs[i], origin_array->ele_size, allocator);
+  }
+  WorkerPool_run(pool, job.chunking.n_chunks, filterChunk, &job);
+
+  Array *filtered_array = Array_new(origin_array->ele_size, allocator);
+  for (uint32_t i = 0; i < job.chunking.n_chunks; i++) {
+    Array * const output = &job.outputs[i];
+    if (output->used_len) { Array_append(filtered_array, output->elements, output->used_len); }
+    Array_reset(output, nullptr);
+  }
+  allocator->free(job.outputs);
+  return filtered_array;
+}
+
+struct ReduceJob {
+  struct Chunking chunking;
+  char *accumulators;  // acc_size * n_chunks
+  uint32_t acc_size;
+  void (*fn_fold)(void *, const void *);
+};
+
+static void reduceChunk(const uint32_t index, void *arg) {
+  const struct ReduceJob * const job = arg;
+  const Array * const origin = job->chunking.array;
+  void * const acc = job->accumulators + (size_t) index * job->acc_size;
+  for (uint32_t i = chunk_begin(&job->chunking, index); i < chunk_end(&job->chunking, index); i++) {
+    job->fn_fold(acc, element_at(origin, i));
+  }
+}
+
+void Array_parallel_reduce(const Array *array, void *result, const uint32_t acc_size,
+                           void (*fn_fold)(void *, const void *),
+                           void (*fn_combine)(void *, const void *), WorkerPool *pool) {
+  struct ReduceJob job = {.acc_size = acc_size, .fn_fold = fn_fold};
+  splitChunks(&job.chunking, array, pool);
+  if (job.chunking.n_chunks == 1) {
+    job.accumulators = result;
+    reduceChunk(0, &job);
+    return;
+  }
+  job.accumulators = array->allocator->malloc((size_t) acc_size * job.chunking.n_chunks);
+  for (uint32_t i = 0; i < job.chunking.n_chunks; i++) {
+    memcpy(job.accumulators + (size_t) i * acc_size, result, acc_size);
+  }
+  WorkerPool_run(pool, job.chunking.n_chunks, reduceChunk, &job);
+  for (uint32_t i = 0; i < job.chunking.n_chunks; i++) {
+    fn_combine(result, job.accumulators + (size_t) i * acc_size);
+  }
+  array->allocator->free(job.accumulators);
+}
+
+// How many elements are detected between two checks of the shared stop flag.
+#define SCAN_CHECK_STRIDE 256
+
+struct ScanJob {
+  struct Chunking chunking;
+  bool (*fn_judgment)(void *);
+  // `any` looks for a true judgment, `all` for a false one.
+  bool wanted;
+  bool short_circuit;
+  atomic_bool found;
+};
+
+static void scanChunk(const uint32_t index, void *arg) {
+  struct ScanJob * const job = arg;
+  const Array * const origin = job->chunking.array;
+  const uint32_t end = chunk_end(&job->chunking, index);
+  bool found = false;
+  for (uint32_t i = chunk_begin(&job->chunking, index); i < end; i++) {
+    if (job->fn_judgment(element_at(origin, i)) == job->wanted) {
+      found = true;
+      if (job->short_circuit) { break; }
+    }
+    if (job->short_circuit && i % SCAN_CHECK_STRIDE == 0
+        && atomic_load_explicit(&job->found, memory_order_relaxed)) {
+      break;
+    }
+  }
+  if (found) { atomic_store_explicit(&job->found, true, memory_order_relaxed); }
+}
+
+static bool scanArray(const Array * const array, bool (*fn_judgment)(void *), const bool wanted,
+                      const enum ARRAY_SCAN_MODE mode, WorkerPool * const pool) {
+  struct ScanJob job = {
+    .fn_judgment = fn_judgment,
+    .wanted = wanted,
+    .short_circuit = mode == ASM_SHORT_CIRCUIT,
+  };
+  atomic_init(&job.found, false);
+  splitChunks(&job.chunking, array, pool);
+  WorkerPool_run(pool, job.chunking.n_chunks, scanChunk, &job);
+  return atomic_load(&job.found);
+}
+
+bool Array_parallel_any(const Array *array, bool (*fn_judgment)(void *),
+                        const enum ARRAY_SCAN_MODE mode, WorkerPool *pool) {
+  return scanArray(array, fn_judgment, true, mode, pool);
+}
+
+bool Array_parallel_all(const Array *array, bool (*fn_judgment)(void *),
+                        const enum ARRAY_SCAN_MODE mode, WorkerPool *pool) {
+  return !scanArray(array, fn_judgment, false, mode, pool);
+}
+
+#define RADIX_BITS    8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+#define define_radix_sort(_name, _key_t)                                                       \
+  bool _name(_key_t *keys, uint32_t *indices, const uint32_t count,                            \
+             const Allocator * const allocator) {                                              \
+    enum { N_PASSES = sizeof(_key_t) * 8 / RADIX_BITS };                                       \
+    if (count < 2) { return true; }                                                            \
+    _key_t *key_buf = allocator->malloc(sizeof(_key_t) * count);                               \
+    uint32_t *index_buf = indices ? allocator->malloc(sizeof(uint32_t) * count) : nullptr;     \
+    uint32_t (*histograms)[RADIX_BUCKETS] = allocator->calloc(N_PASSES, sizeof(*histograms));  \
+    if (!key_buf || (indices && !index_buf) || !histograms) {                                  \
+      allocator->free(key_buf);                                                                \
+      allocator->free(index_buf);                                                              \
+      allocator->free(histograms);                                                             \
+      return false;                                                                            \
+    }                                                                                          \
+    for (uint32_t i = 0; i < count; i++) {                                                     \
+      const _key_t key = keys[i];                                                              \
+      for (int p = 0; p < N_PASSES; p++) {                                                     \
+        histograms[p][(key >> (p * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;                      \
+      }                                                                                        \
+    }                                                                                          \
+    _key_t *src_keys = keys, *dst_keys = key_buf;                                              \
+    uint32_t *src_indices = indices, *dst_indices = index_buf;                                 \
+    for (int p = 0; p < N_PASSES; p++) {                                                       \
+      uint32_t * const histogram = histograms[p];                                              \
+      const uint32_t digit0 = (src_keys[0] >> (p * RADIX_BITS)) & (RADIX_BUCKETS - 1);         \
+      if (histogram[digit0] == count) { continue; }                                            \
+      uint32_t offset = 0;                                                                     \
+      for (int b = 0; b < RADIX_BUCKETS; b++) {                                                \
+        const uint32_t n = histogram[b];                                                       \
+        histogram[b] = offset;                                                                 \
+        offset += n;                                                                           \
+      }                                                                                        \
+      for (uint32_t i = 0; i < count; i++) {                                                   \
+        const uint32_t digit = (src_keys[i] >> (p * RADIX_BITS)) & (RADIX_BUCKETS - 1);        \
+        const uint32_t dest = histogram[digit]++;                                              \
+        dst_keys[dest] = src_keys[i];                                                          \
+        if (src_indices) { dst_indices[dest] = src_indices[i]; }                               \
+      }                                                                                        \
+      _key_t * const tmp_keys = src_keys;                                                      \
+      src_keys = dst_keys;                                                                     \
+      dst_keys = tmp_keys;                                                                     \
+      uint32_t * const tmp_indices = src_indices;                                              \
+      src_indices = dst_indices;                                                               \
+      dst_indices = tmp_indices;                                                               \
+    }                                                                                          \
+    if (src_keys != keys) {                                                                    \
+      memcpy(keys, src_keys, sizeof(_key_t) * count);                                          \
+      if (indices) { memcpy(indices, src_indices, sizeof(uint32_t) * count); }                 \
+    }                                                                                          \
+    allocator->free(key_buf);                                                                  \
+    allocator->free(index_buf);                                                                \
+    allocator->free(histograms);                                                               \
+    return true;                                                                               \
+  }
+
+define_radix_sort(radixSortU32, uint32_t)
+define_radix_sort(radixSortU64, uint64_t)
+
+bool Array_sort(Array *array, uint64_t (*fn_key)(const void *)) {
+  const uint32_t count = array->used_len;
+  if (count < 2) { return true; }
+  if (array->storage == AS_FILE) { return false; }
+  const Allocator * const allocator = array->allocator;
+  uint64_t *keys = allocator->malloc(sizeof(uint64_t) * count);
+  uint32_t *indices = allocator->malloc(sizeof(uint32_t) * count);
+  const uint32_t n_scratch = array->storage == AS_HEAP ? array->alloc_len : count;
+  void *elements = allocator->malloc((size_t) n_scratch * array->ele_size);
+  if (!keys || !indices || !elements) { goto __sort_failed; }
+  for (uint32_t i = 0; i < count; i++) {
+    keys[i] = fn_key((char *) array->elements + (size_t) i * array->ele_size);
+    indices[i] = i;
+  }
+  if (!radixSortU64(keys, indices, count, allocator)) { goto __sort_failed; }
+  for (uint32_t i = 0; i < count; i++) {
+    memcpy((char *) elements + (size_t) i * array->ele_size,
+           (char *) array->elements + (size_t) indices[i] * array->ele_size, array->ele_size);
+  }
+  if (array->storage == AS_HEAP) {
+    allocator->free(array->elements);
+    array->elements = elements;
+  } else {
+    memcpy(array->elements, elements, (size_t) count * array->ele_size);
+    allocator->free(elements);
+  }
+  allocator->free(keys);
+  allocator->free(indices);
+  return true;
+__sort_failed:
+  allocator->free(keys);
+  allocator->free(indices);
+  allocator->free(elements);
+  return false;
+}
+
+void *Array_bsearch(const Array *array, const uint64_t key, uint64_t (*fn_key)(const void *)) {
+  uint32_t low = 0, high = array->used_len;
+  while (low < high) {
+    const uint32_t mid = low + (high - low) / 2;
+    if (fn_key((char *) array->elements + (size_t) mid * array->ele_size) < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == array->used_len) { return nullptr; }
+  void *element = (char *) array->elements + (size_t) low * array->ele_size;
+  return fn_key(element) == key ? element : nullptr;
+}
+
 uint32_t Array_clear(Array *array, void (*fn_free)(void *, const Allocator *)) {
   if (fn_free) {
     for (uint32_t i = 0; i < array->used_len; i++) {
@@ -120,7 +570,7 @@ uint32_t Array_clear(Array *array, void (*fn_free)(void *, const Allocator *)) {
 uint32_t Array_reset(Array *array, void (*fn_free)(void *, const Allocator *)) {
   Array_clear(array, fn_free);
   const uint32_t len = array->alloc_len;
-  if (array->elements) { array->allocator->free(array->elements); }
+  releaseElements(array);
   array->elements = nullptr;
   array->alloc_len = 0;
   array->used_len = 0;
@@ -130,3 +580,68 @@ uint32_t Array_reset(Array *array, void (*fn_free)(void *, const Allocator *)) {
 void Array_destroy(Array *array) {
   array->allocator->free(array);
 }
+
+#define small_elements(_array) \
+  ((_array)->alloc_len > (_array)->n_inline ? (_array)->spilled : (void *) ((_array) + 1))
+
+uint32_t SmallArray_init(SmallArray *array, const uint32_t ele_size, const uint32_t n_inline,
+                         const Allocator *allocator) {
+  array->allocator = allocator;
+  array->ele_size = ele_size;
+  array->n_inline = n_inline;
+  array->alloc_len = n_inline;
+  array->used_len = 0;
+  array->spilled = nullptr;
+  return ele_size;
+}
+
+inline uint32_t SmallArray_length(const SmallArray *array) {
+  return array->used_len;
+}
+
+inline void *SmallArray_get(const SmallArray *array, uint32_t index) {
+  if (index >= array->used_len) { return nullptr; }
+  return (char *) small_elements(array) + array->ele_size * index;
+}
+
+uint32_t SmallArray_append(SmallArray *array, const void *elements, const uint32_t count) {
+  if (array->used_len + count > array->alloc_len) {
+    uint32_t length = ((array->used_len + count) / ALLOC_LEN + 1) * ALLOC_LEN;
+    void *p;
+    if (array->alloc_len > array->n_inline) {
+      p = array->allocator->realloc(array->spilled, length * array->ele_size);
+      if (!p) { return -1; }
+    } else {
+      p = array->allocator->malloc(length * array->ele_size);
+      if (!p) { return -1; }
+      memcpy(p, (void *) (array + 1), array->used_len * array->ele_size);
+    }
+    array->spilled = p;
+    array->alloc_len = length;
+  }
+  void *dest = (char *) small_elements(array) + array->ele_size * array->used_len;
+  memcpy(dest, elements, count * array->ele_size);
+  array->used_len += count;
+  return count;
+}
+
+uint32_t SmallArray_clear(SmallArray *array, void (*fn_free)(void *, const Allocator *)) {
+  if (fn_free) {
+    for (uint32_t i = 0; i < array->used_len; i++) {
+      void *ele = SmallArray_get(array, i);
+      fn_free(ele, array->allocator);
+    }
+  }
+  const uint32_t len = array->used_len;
+  array->used_len = 0;
+  return len;
+}
+
+uint32_t SmallArray_reset(SmallArray *array, void (*fn_free)(void *, const Allocator *)) {
+  SmallArray_clear(array, fn_free);
+  const uint32_t len = array->alloc_len;
+  if (array->alloc_len > array->n_inline) { array->allocator->free(array->spilled); }
+  array->spilled = nullptr;
+  array->alloc_len = array->n_inline;
+  return len;
+}
@@ -11,6 +11,7 @@
 #define XIDE_ARRAY_H
 
 #include "allocator.h"
+#include "pool.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -21,6 +22,15 @@ extern const size_t sizeof_array;
 Array *Array_new(uint32_t ele_size, const Allocator *allocator);
 
 uint32_t Array_init(Array *array, const uint32_t ele_size, const Allocator *allocator);
+// Array whose elements live in an anonymous memory mapping which grows by `mremap`,
+// so large buffers are never copied when they grow. Header is still from `allocator`.
+// Same as `Array_new` where `mremap` is not available.
+Array *Array_new_mapped(uint32_t ele_size, const Allocator *allocator);
+// Expose file at `path` as a read-only array of `ele_size` elements, by mapping it
+// rather than reading it. Trailing bytes of less than `ele_size` are not exposed.
+// Append on it always fails. `Array_reset` unmaps the file.
+// Return nullptr if file could not be opened or mapped.
+Array *Array_map_file(const char *path, uint32_t ele_size, const Allocator *allocator);
 
 uint32_t Array_length(const struct Array *array);
 
@@ -29,6 +39,10 @@ uint32_t Array_length(const struct Array *array);
 // same address.
 void *Array_get(const struct Array *array, uint32_t index);
 uint32_t Array_append(struct Array *array, const void *elements, uint32_t count);
+// Insert `count` elements before `index`; `index` may be the length to append.
+uint32_t Array_insert(struct Array *array, uint32_t index, const void *elements, uint32_t count);
+// Remove `count` elements from `index`, and move later elements forward.
+uint32_t Array_remove(struct Array *array, uint32_t index, uint32_t count);
 
 // Promised that every element would be detected with `fn_judgment`.
 // So that for traversing elements.
@@ -44,6 +58,42 @@ uint32_t Array_no_duplicated_concat(struct Array * restrict _to,
 Array *Array_filter(const Array *origin_array, bool (*fn_judgment)(const void *));
 // Deduplicate an array by fn_equal. The origin_array will not be clean and destroy.
 Array *Array_deduplicate(const Array *origin_array, bool (*fn_equal)(const void *, const void *));
+// Parallel variants split array into chunks of at least `ARRAY_PARALLEL_GRAIN`
+// elements and run them on `pool` (or inline if `pool` is nullptr).
+// Callbacks are invoked concurrently, so they must be thread-safe.
+#define ARRAY_PARALLEL_GRAIN 4096
+
+enum ARRAY_SCAN_MODE {
+  // Detect every element, as `Array_any` and `Array_all` do.
+  ASM_EXHAUSTIVE = 0,
+  // Stop all chunks as soon as the result is known.
+  ASM_SHORT_CIRCUIT = 1,
+};
+
+// Map every element to an element of `ele_size` by `fn_map(origin, mapped)`, in order.
+Array *Array_parallel_map(const Array *origin_array, uint32_t ele_size,
+                          void (*fn_map)(const void *, void *), WorkerPool *pool);
+// Same as `Array_filter`; every chunk filters into its own buffer, then buffers are
+// concatenated in order.
+Array *Array_parallel_filter(const Array *origin_array, bool (*fn_judgment)(const void *),
+                             WorkerPool *pool);
+// Fold elements into `result` (`acc_size` bytes, holding the identity value when called)
+// by `fn_fold(acc, element)`. Every chunk folds into a copy of the identity, then chunk
+// results are merged in order by `fn_combine(acc, chunk_acc)`.
+void Array_parallel_reduce(const Array *array, void *result, uint32_t acc_size,
+                           void (*fn_fold)(void *, const void *),
+                           void (*fn_combine)(void *, const void *), WorkerPool *pool);
+bool Array_parallel_any(const Array *array, bool (*fn_judgment)(void *), enum ARRAY_SCAN_MODE mode,
+                        WorkerPool *pool);
+bool Array_parallel_all(const Array *array, bool (*fn_judgment)(void *), enum ARRAY_SCAN_MODE mode,
+                        WorkerPool *pool);
+
+// Stably sort elements in ascending order of `fn_key`, by `radixSortU64`.
+// Return false when scratch memory could not be allocated, and array is unchanged.
+bool Array_sort(struct Array *array, uint64_t (*fn_key)(const void *));
+// Suppose array is sorted by `fn_key`. Return the first element whose key is `key`,
+// or nullptr if there is none.
+void *Array_bsearch(const struct Array *array, uint64_t key, uint64_t (*fn_key)(const void *));
 // Clear array and free all element with `fn_free`.
 uint32_t Array_clear(struct Array *array, void (*fn_free)(void *, const Allocator *));
 // Reset array and free all element with `fn_free`.
@@ -51,10 +101,55 @@ uint32_t Array_reset(struct Array *array, void (*fn_free)(void *, const Allocato
 // Maybe cause memory leak if not reset array before destroy it.
 void Array_destroy(struct Array *array);
 
+// LSD radix sort of `count` keys in ascending order, 8 bits per pass. It is stable,
+// and passes on which all keys share the same digit are skipped.
+// `indices` is the payload moved along with keys, and may be nullptr.
+// Scratch buffers are from `allocator`; return false if they could not be allocated.
+bool radixSortU32(uint32_t *keys, uint32_t *indices, uint32_t count, const Allocator *allocator);
+bool radixSortU64(uint64_t *keys, uint32_t *indices, uint32_t count, const Allocator *allocator);
+
 #define releaseArray(_array)      \
   do {                            \
     Array_reset(_array, nullptr); \
     Array_destroy(_array);        \
   } while (false)
 
+// Array whose first `n_inline` elements live right after the header, so
+// small collections need no allocation at all. It spills to the allocator
+// only when it grows beyond `n_inline`.
+// Declare one with `SmallArrayOf(type, n)` and pass `&x.head` to functions.
+// A SmallArray holds no pointer to itself, so it may be copied by value;
+// the copy takes over the spilled block (if any).
+typedef struct SmallArray {
+  const Allocator *allocator;
+  uint32_t ele_size;
+  uint32_t n_inline;
+  uint32_t alloc_len;
+  uint32_t used_len;
+  void *spilled;
+} SmallArray;
+
+#define SmallArrayOf(_type, _n) \
+  struct {                      \
+    SmallArray head;            \
+    _type inline_elements[_n];  \
+  }
+
+uint32_t SmallArray_init(SmallArray *array, uint32_t ele_size, uint32_t n_inline,
+                         const Allocator *allocator);
+uint32_t SmallArray_length(const SmallArray *array);
+// Note: same as `Array_get`, append may move elements from inline storage to heap.
+void *SmallArray_get(const SmallArray *array, uint32_t index);
+uint32_t SmallArray_append(SmallArray *array, const void *elements, uint32_t count);
+// Clear array and free all element with `fn_free`.
+uint32_t SmallArray_clear(SmallArray *array, void (*fn_free)(void *, const Allocator *));
+// Reset array to its inline storage and free all element with `fn_free`.
+uint32_t SmallArray_reset(SmallArray *array, void (*fn_free)(void *, const Allocator *));
+
+#define n_inline_of(_small) \
+  (sizeof((_small)->inline_elements) / sizeof((_small)->inline_elements[0]))
+#define initSmallArray(_small, _allocator)                                                     \
+  SmallArray_init(&(_small)->head, sizeof((_small)->inline_elements[0]), n_inline_of(_small), \
+                  _allocator)
+
 #endif  // XIDE_ARRAY_H
\ No newline at end of file
@@ -0,0 +1,225 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: batch.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "batch.h"
+#include "gpu-timer.h"
+#include "program.h"
+#include "state.h"
+#include "view.h"
+#include <stdint.h>
+
+// Same uniform values, including the view state bound for screen tasks.
+static bool sameUniforms(const DrawTask * const task1, const DrawTask * const task2) {
+  return task1->depth == task2->depth && !((task1->flags ^ task2->flags) & TF_SCREEN)
+         && SmallArray_length(&task1->uniforms.head) == SmallArray_length(&task2->uniforms.head);
+}
+
+DrawBatchList *xglCreateBatchList(const Allocator * const allocator) {
+  DrawBatchList *list = allocator->calloc(1, sizeof(DrawBatchList));
+  list->allocator = allocator;
+  list->batches = Array_new(sizeof(DrawBatch), allocator);
+  list->commands = Array_new(sizeof(DrawElementsIndirectCommand), allocator);
+  // No task list has version -1, so the first compile always happens.
+  list->version = UINT64_MAX;
+  return list;
+}
+
+void xglDestroyBatchList(DrawBatchList *list) {
+  if (list->indirect_buffer) { glDeleteBuffers(1, &list->indirect_buffer); }
+  releaseArray(list->batches);
+  releaseArray(list->commands);
+  list->allocator->free(list);
+}
+
+void xglCompileBatches(DrawBatchList *list, const DrawTask *tasks, const uint32_t *order,
+                       const uint32_t n_order, const uint64_t version) {
+  if (list->version == version) { return; }
+  list->version = version;
+  Array_clear(list->batches, nullptr);
+  Array_clear(list->commands, nullptr);
+
+  DrawBatch *batch = nullptr;
+  for (uint32_t i = 0; i < n_order; i++) {
+    const DrawTask * const task = &tasks[order[i]];
+    GLenum mode, polygon_mode;
+    xglTaskModes(task, &mode, &polygon_mode);
+    if (mode == GL_NONE || task->program == 0 || task->n_index == 0) { continue; }
+    if (task->task_type == TT_RECTS) {
+      const DrawBatch rects = {
+        .program = task->program,
+        .VAO = task->VAO,
+        .mode = mode,
+        .polygon_mode = polygon_mode,
+        .task = task,
+        .first_command = Array_length(list->commands),
+        .n_commands = 0,
+      };
+      Array_append(list->batches, &rects, 1);
+      batch = nullptr;
+      continue;
+    }
+    if (!batch || batch->program != task->program || batch->VAO != task->VAO
+        || batch->mode != mode || batch->polygon_mode != polygon_mode
+        || !sameUniforms(batch->task, task)) {
+      const DrawBatch new_batch = {
+        .program = task->program,
+        .VAO = task->VAO,
+        .mode = mode,
+        .polygon_mode = polygon_mode,
+        .task = task,
+        .first_command = Array_length(list->commands),
+        .n_commands = 0,
+      };
+      Array_append(list->batches, &new_batch, 1);
+      batch = Array_get(list->batches, Array_length(list->batches) - 1);
+    }
+    const DrawElementsIndirectCommand command = {
+      .count = (GLuint) task->n_index,
+      .instanceCount = 1,
+      .firstIndex = task->index_block.offset,
+      .baseVertex = (GLint) task->vertex_block.offset,
+      .baseInstance = 0,
+    };
+    Array_append(list->commands, &command, 1);
+    batch->n_commands++;
+    batch->n_indices += command.count;
+  }
+
+  const uint32_t n_commands = Array_length(list->commands);
+  if (n_commands > list->buffer_capacity) {
+    if (list->indirect_buffer) { glDeleteBuffers(1, &list->indirect_buffer); }
+    uint32_t capacity = list->buffer_capacity ? list->buffer_capacity : 64;
+    while (capacity < n_commands) { capacity *= 2; }
+    glCreateBuffers(1, &list->indirect_buffer);
+    glNamedBufferStorage(list->indirect_buffer,
+                         (GLsizeiptr) capacity * sizeof(DrawElementsIndirectCommand), nullptr,
+                         GL_DYNAMIC_STORAGE_BIT);
+    list->buffer_capacity = capacity;
+  }
+  if (n_commands) {
+    glNamedBufferSubData(list->indirect_buffer, 0,
+                         (GLsizeiptr) n_commands * sizeof(DrawElementsIndirectCommand),
+                         Array_get(list->commands, 0));
+    xglCountUpload((uint64_t) n_commands * sizeof(DrawElementsIndirectCommand));
+  }
+}
+
+void xglDrawBatches(const DrawBatchList *list) {
+  const uint32_t n_batches = Array_length(list->batches);
+  if (n_batches == 0) { return; }
+  const DrawBatch * const batches = Array_get(list->batches, 0);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, list->indirect_buffer);
+  for (uint32_t i = 0; i < n_batches; i++) {
+    const DrawBatch * const batch = &batches[i];
+    xglGpuMark(batch->task->task_type);
+    xglUseViewState(batch->task->flags & TF_SCREEN);
+    if (batch->n_commands == 0) {
+      xglDraw(batch->task);
+      continue;
+    }
+    xglUseProgram(batch->program);
+    xglBindVertexArray(batch->VAO);
+    if (batch->mode == GL_TRIANGLES) { xglPolygonMode(batch->polygon_mode); }
+    xglUploadUniforms(batch->task);
+    const uintptr_t offset = batch->first_command * sizeof(DrawElementsIndirectCommand);
+    glMultiDrawElementsIndirect(batch->mode, GL_UNSIGNED_INT, (const void *) offset,
+                                (GLsizei) batch->n_commands, 0);
+    xglCountDraw(batch->mode, batch->n_indices, 1);
+  }
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+DrawPasses *xglCreateDrawPasses(const Allocator * const allocator) {
+  DrawPasses *passes = allocator->calloc(1, sizeof(DrawPasses));
+  passes->opaque = xglCreateBatchList(allocator);
+  passes->blended = xglCreateBatchList(allocator);
+  passes->dynamic = Array_new(sizeof(uint32_t), allocator);
+  passes->version = UINT64_MAX;
+  return passes;
+}
+
+void xglDestroyDrawPasses(DrawPasses *passes) {
+  const Allocator * const allocator = passes->opaque->allocator;
+  xglDestroyBatchList(passes->opaque);
+  xglDestroyBatchList(passes->blended);
+  releaseArray(passes->dynamic);
+  allocator->free(passes);
+}
+
+// Sort `indices` of tasks by their sort keys, with `keys` as scratch.
+static void sortTasks(const DrawTask * const tasks, uint32_t * const indices, uint64_t * const keys,
+                      const uint32_t count, const Allocator * const allocator) {
+  for (uint32_t i = 0; i < count; i++) { keys[i] = tasks[indices[i]].sort_key; }
+  radixSortU64(keys, indices, count, allocator);
+}
+
+// Hidden tasks, and tasks whose program is still compiling, are left out of passes.
+static bool taskSkipped(const DrawTask * const task) {
+  return (task->flags & TF_HIDDEN) || xglProgramPending(task->program);
+}
+
+void xglCompileDrawPasses(DrawPasses *passes, const DrawTask *tasks, const uint32_t n_tasks,
+                          const uint64_t version) {
+  if (passes->version == version && passes->tasks == tasks) { return; }
+  passes->version = version;
+  // Batches point into `tasks`, so they are recompiled even at the same version.
+  passes->opaque->version = passes->blended->version = UINT64_MAX;
+  passes->tasks = tasks;
+  Array_clear(passes->dynamic, nullptr);
+  const Allocator * const allocator = passes->opaque->allocator;
+  uint32_t * const indices = allocator->malloc(sizeof(uint32_t) * (n_tasks + 1));
+  uint64_t * const keys = allocator->malloc(sizeof(uint64_t) * (n_tasks + 1));
+  // opaque tasks from head of `indices`, blended ones from tail.
+  uint32_t n_opaque = 0, n_blended = 0;
+  for (uint32_t i = 0; i < n_tasks; i++) {
+    if (taskSkipped(&tasks[i])) { continue; }
+    if (tasks[i].flags & TF_DYNAMIC) {
+      Array_append(passes->dynamic, &i, 1);
+    } else if (tasks[i].flags & TF_OPAQUE) {
+      indices[n_opaque++] = i;
+    } else {
+      n_blended++;
+    }
+  }
+  for (uint32_t i = 0, j = n_opaque; i < n_tasks; i++) {
+    if (!(tasks[i].flags & (TF_OPAQUE | TF_DYNAMIC)) && !taskSkipped(&tasks[i])) {
+      indices[j++] = i;
+    }
+  }
+  sortTasks(tasks, indices, keys, n_opaque, allocator);
+  sortTasks(tasks, indices + n_opaque, keys, n_blended, allocator);
+  xglCompileBatches(passes->opaque, tasks, indices, n_opaque, version);
+  xglCompileBatches(passes->blended, tasks, indices + n_opaque, n_blended, version);
+  allocator->free(indices);
+  allocator->free(keys);
+}
+
+void xglInvalidateDrawPasses(DrawPasses *passes) {
+  passes->version = UINT64_MAX;
+}
+
+void xglDrawPasses(const DrawPasses *passes) {
+  xglDepthFunc(GL_LEQUAL);
+  xglSetDepthTest(true);
+  xglDepthMask(true);
+  xglSetBlend(false);
+  xglDrawBatches(passes->opaque);
+  xglDepthMask(false);
+  xglSetBlend(true);
+  xglDrawBatches(passes->blended);
+  const uint32_t n_dynamic = Array_length(passes->dynamic);
+  const uint32_t * const dynamic = Array_get(passes->dynamic, 0);
+  for (uint32_t i = 0; i < n_dynamic; i++) {
+    const DrawTask * const task = &passes->tasks[dynamic[i]];
+    if (!task->program || !task->n_index) { continue; }
+    xglGpuMark(task->task_type);
+    xglUseViewState(task->flags & TF_SCREEN);
+    xglDraw(task);
+  }
+}
@@ -0,0 +1,78 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: batch.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_BATCH_H
+#define XIDE_BATCH_H
+
+#include "draw.h"
+
+typedef struct DrawElementsIndirectCommand {
+  GLuint count;
+  GLuint instanceCount;
+  GLuint firstIndex;
+  GLint baseVertex;
+  GLuint baseInstance;
+} DrawElementsIndirectCommand;
+
+// Run of consecutive tasks with the same program, VAO, primitive type, polygon
+// mode and uniform values, submitted by one `glMultiDrawElementsIndirect`.
+// A rectangles task is already one instanced draw call, and is a batch of its own
+// without commands.
+typedef struct DrawBatch {
+  iXGLshProg program;
+  iXGLVao VAO;
+  GLenum mode;
+  GLenum polygon_mode;
+  const DrawTask *task;  // first task, whose uniforms are uploaded for batch
+  uint32_t first_command;
+  uint32_t n_commands;
+  uint64_t n_indices;  // of all commands
+} DrawBatch;
+
+typedef struct DrawBatchList {
+  const Allocator *allocator;
+  Array *batches;   // Array<DrawBatch>
+  Array *commands;  // Array<DrawElementsIndirectCommand>
+  iXGLVbo indirect_buffer;
+  uint32_t buffer_capacity;
+  uint64_t version;
+} DrawBatchList;
+
+DrawBatchList *xglCreateBatchList(const Allocator *allocator);
+void xglDestroyBatchList(DrawBatchList *list);
+// Compile `tasks` in the order of `order` (indices into `tasks`) into batches and
+// upload their commands, unless `version` is the one batches were compiled from.
+// Tasks must not move until next compile.
+void xglCompileBatches(DrawBatchList *list, const DrawTask *tasks, const uint32_t *order,
+                       uint32_t n_order, uint64_t version);
+void xglDrawBatches(const DrawBatchList *list);
+
+// Draw passes of a task list: opaque tasks front-to-back with depth test and depth
+// write, then blended tasks back-to-front with depth test only. Sorting is by the
+// cached `DrawTask::sort_key`, and only redone when task list version changes or
+// the task list moves.
+// Dynamic tasks move between stream ring regions every frame, so they are not
+// batched but drawn one by one after both passes.
+typedef struct DrawPasses {
+  DrawBatchList *opaque;
+  DrawBatchList *blended;
+  const DrawTask *tasks;
+  Array *dynamic;  // Array<uint32_t> of indices into `tasks`
+  uint64_t version;
+} DrawPasses;
+
+DrawPasses *xglCreateDrawPasses(const Allocator *allocator);
+void xglDestroyDrawPasses(DrawPasses *passes);
+void xglCompileDrawPasses(DrawPasses *passes, const DrawTask *tasks, uint32_t n_tasks,
+                          uint64_t version);
+// Make next compile happen even at the same version, e.g. after a program became ready.
+void xglInvalidateDrawPasses(DrawPasses *passes);
+void xglDrawPasses(const DrawPasses *passes);
+
+#endif  // XIDE_BATCH_H
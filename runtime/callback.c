@@ -12,21 +12,31 @@
 #include <stdbool.h>
 #include <stdio.h>
 extern iXGLshProg BUILTIN_GRADUAL_SHADER_PROGRAM;
+// GL context belongs to the render thread, which resizes viewport and back buffer
+// when it draws a frame of new view size.
 void ideSetWindowSize(GLFWwindow *handle, int width, int height) {
-  glViewport(0, 0, width, height);
   IdeWindow *window = glfwGetWindowUserPointer(handle);
-  GLint viewport[4] = {};
-  glGetIntegerv(GL_VIEWPORT, viewport);
-  window->viewport[0] = (float) viewport[0];
-  window->viewport[1] = (float) viewport[1];
-  window->viewport[2] = (float) viewport[2];
-  window->viewport[3] = (float) viewport[3];
+  window->viewport[0] = 0;
+  window->viewport[1] = 0;
+  window->viewport[2] = (float) width;
+  window->viewport[3] = (float) height;
+  xglSetViewSize(window->viewport[2], window->viewport[3]);
 }
 
+// Content of window is lost, but that of back buffer is not. Publish from here rather
+// than from the UI loop, which does not run while Windows drags a window to size or move.
 void ideWindowRefreshCallback(GLFWwindow *handle) {
   IdeWindow *window = glfwGetWindowUserPointer(handle);
-  ideDrawUI(window);
-  glFinish();
+  if (xglDamageRegionEmpty(xglGetDamage())) {
+    idePresentFrame(window);
+  } else {
+    idePublishFrame(window);
+  }
+}
+
+void ideKeyCallback(GLFWwindow *handle, int key, int scancode, int action, int mods) {
+  IdeWindow *window = glfwGetWindowUserPointer(handle);
+  if (key == GLFW_KEY_F3 && action == GLFW_PRESS) { ideToggleHud(window); }
 }
 
 void ideProcessInput(GLFWwindow *window) {
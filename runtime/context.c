@@ -8,3 +8,243 @@
  **/
 
 #include "context.h"
+#include "state.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#define OP_SHIFT 8
+#define OP_MASK  ((1u << OP_SHIFT) - 1)
+
+static uint32_t floatBits(const GLfloat value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static GLfloat bitsFloat(const uint32_t bits) {
+  GLfloat value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static void record(RenderContext * const context, const enum RENDER_OP op,
+                   const uint32_t *payload, const uint32_t n_payload) {
+  const uint32_t header = (uint32_t) op | n_payload << OP_SHIFT;
+  Array_append(context->words, &header, 1);
+  if (n_payload) { Array_append(context->words, payload, n_payload); }
+  context->n_commands++;
+}
+
+static void recordRect(RenderContext * const context, const enum RENDER_OP op,
+                       const GLfloat rect[4]) {
+  const uint32_t payload[4] = {
+    floatBits(rect[0]), floatBits(rect[1]), floatBits(rect[2]), floatBits(rect[3]),
+  };
+  record(context, op, payload, 4);
+}
+
+RenderContext *xglCreateRenderContext(const Allocator * const allocator) {
+  RenderContext *context = allocator->calloc(1, sizeof(RenderContext));
+  context->allocator = allocator;
+  context->words = Array_new(sizeof(uint32_t), allocator);
+  return context;
+}
+
+void xglDestroyRenderContext(RenderContext *context) {
+  releaseArray(context->words);
+  context->allocator->free(context);
+}
+
+void xglContextReset(RenderContext *context) {
+  Array_clear(context->words, nullptr);
+  context->n_commands = 0;
+  context->clip_depth = 0;
+}
+
+void xglContextBindProgram(RenderContext *context, const GLuint program) {
+  record(context, RO_PROGRAM, &program, 1);
+}
+
+void xglContextUniform1f(RenderContext *context, const GLint location, const GLfloat value) {
+  const uint32_t payload[2] = {(uint32_t) location, floatBits(value)};
+  record(context, RO_UNIFORM_1F, payload, 2);
+}
+
+void xglContextUniform2f(RenderContext *context, const GLint location, const GLfloat value[2]) {
+  const uint32_t payload[3] = {(uint32_t) location, floatBits(value[0]), floatBits(value[1])};
+  record(context, RO_UNIFORM_2F, payload, 3);
+}
+
+void xglContextDraw(RenderContext *context, const GLuint VAO, const GLenum mode,
+                    const GLenum polygon_mode, const GLsizei count, const uintptr_t index_offset,
+                    const GLint base_vertex) {
+  const uint32_t payload[6] = {
+    VAO, mode, polygon_mode, (uint32_t) count, (uint32_t) index_offset, (uint32_t) base_vertex,
+  };
+  record(context, RO_DRAW, payload, 6);
+}
+
+void xglContextDrawInstanced(RenderContext *context, const GLuint VAO, const GLenum mode,
+                             const GLsizei count, const GLsizei n_instances,
+                             const GLuint base_instance) {
+  const uint32_t payload[5] = {
+    VAO, mode, (uint32_t) count, (uint32_t) n_instances, base_instance,
+  };
+  record(context, RO_DRAW_INSTANCED, payload, 5);
+}
+
+void xglContextDrawTask(RenderContext *context, const DrawTask *task) {
+  GLenum mode, polygon_mode;
+  xglTaskModes(task, &mode, &polygon_mode);
+  if (mode == GL_NONE || task->program == 0 || task->n_index == 0) { return; }
+  if (task->task_type == TT_RECTS && task->vertex_block.count == 0) { return; }
+  xglContextBindProgram(context, task->program);
+  for (uint32_t i = 0; i < SmallArray_length(&task->uniforms.head); i++) {
+    const iXGLVUniform *uniform = SmallArray_get(&task->uniforms.head, i);
+    if (uniform->u_locate == LOC_PLANE_DEPTH) {
+      xglContextUniform1f(context, uniform->u_locate, task->depth);
+    }
+  }
+  if (task->task_type == TT_RECTS) {
+    xglContextDrawInstanced(context, task->VAO, mode, task->n_index,
+                            (GLsizei) task->vertex_block.count, task->vertex_block.offset);
+    return;
+  }
+  xglContextDraw(context, task->VAO, mode, polygon_mode, task->n_index,
+                 (uintptr_t) xglTaskIndexOffset(task), xglTaskBaseVertex(task));
+}
+
+void xglContextScissor(RenderContext *context, const GLfloat rect[4]) {
+  recordRect(context, RO_SCISSOR, rect);
+}
+
+void xglContextPushClip(RenderContext *context, const GLfloat rect[4]) {
+  recordRect(context, RO_PUSH_CLIP, rect);
+  context->clip_depth++;
+}
+
+void xglContextPopClip(RenderContext *context) {
+  if (context->clip_depth == 0) { return; }
+  record(context, RO_POP_CLIP, nullptr, 0);
+  context->clip_depth--;
+}
+
+void xglContextAppend(RenderContext *dest, const RenderContext *src) {
+  const uint32_t n_words = Array_length(src->words);
+  if (n_words) { Array_append(dest->words, Array_get(src->words, 0), n_words); }
+  dest->n_commands += src->n_commands;
+  for (uint32_t i = 0; i < src->clip_depth; i++) { record(dest, RO_POP_CLIP, nullptr, 0); }
+}
+
+static void intersectRect(GLfloat rect[4], const GLfloat other[4]) {
+  rect[0] = fmaxf(rect[0], other[0]);
+  rect[1] = fmaxf(rect[1], other[1]);
+  rect[2] = fminf(rect[2], other[2]);
+  rect[3] = fminf(rect[3], other[3]);
+}
+
+static void readRect(const uint32_t *payload, GLfloat rect[4]) {
+  for (int i = 0; i < 4; i++) { rect[i] = bitsFloat(payload[i]); }
+}
+
+// Scissor box of clip `rect`, or no scissor test for the unbounded clip.
+static void applyClip(const GLfloat rect[4], const GLsizei height) {
+  if (rect[2] == FLT_MAX && rect[3] == FLT_MAX && rect[0] == -FLT_MAX && rect[1] == -FLT_MAX) {
+    xglSetScissor(false);
+    return;
+  }
+  const GLfloat limit = (GLfloat) INT16_MAX;
+  const GLint x0 = (GLint) fminf(fmaxf(floorf(rect[0]), 0), limit);
+  const GLint y0 = (GLint) fminf(fmaxf(floorf(rect[1]), 0), limit);
+  const GLint x1 = (GLint) fminf(fmaxf(ceilf(rect[2]), 0), limit);
+  const GLint y1 = (GLint) fminf(fmaxf(ceilf(rect[3]), 0), limit);
+  xglSetScissor(true);
+  xglScissor(x0, height - y1, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+}
+
+void xglContextReplay(const RenderContext *context, const GLfloat clip[4], const GLsizei height) {
+  const uint32_t n_words = Array_length(context->words);
+  if (n_words == 0) { return; }
+  const uint32_t * const words = Array_get(context->words, 0);
+
+  GLfloat clips[XGL_CLIP_DEPTH + 1][4];
+  uint32_t depth = 0, ignored = 0;
+  if (clip) {
+    memcpy(clips[0], clip, sizeof(clips[0]));
+  } else {
+    const GLfloat unbounded[4] = {-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX};
+    memcpy(clips[0], unbounded, sizeof(clips[0]));
+  }
+  applyClip(clips[0], height);
+
+  GLuint program = 0;
+  for (uint32_t i = 0; i < n_words;) {
+    const uint32_t header = words[i];
+    const uint32_t * const payload = &words[i + 1];
+    i += 1 + (header >> OP_SHIFT);
+    switch ((enum RENDER_OP) (header & OP_MASK)) {
+      case RO_PROGRAM: {
+        program = payload[0];
+        xglUseProgram(program);
+        break;
+      }
+      case RO_UNIFORM_1F: {
+        xglProgramUniform1f(program, (GLint) payload[0], bitsFloat(payload[1]));
+        break;
+      }
+      case RO_UNIFORM_2F: {
+        const GLfloat value[2] = {bitsFloat(payload[1]), bitsFloat(payload[2])};
+        xglProgramUniform2fv(program, (GLint) payload[0], value);
+        break;
+      }
+      case RO_DRAW: {
+        xglBindVertexArray(payload[0]);
+        if (payload[1] == GL_TRIANGLES) { xglPolygonMode(payload[2]); }
+        glDrawElementsBaseVertex(payload[1], (GLsizei) payload[3], GL_UNSIGNED_INT,
+                                 (const void *) (uintptr_t) payload[4], (GLint) payload[5]);
+        xglCountDraw(payload[1], payload[3], 1);
+        break;
+      }
+      case RO_DRAW_INSTANCED: {
+        xglBindVertexArray(payload[0]);
+        xglPolygonMode(GL_FILL);
+        glDrawArraysInstancedBaseInstance(payload[1], 0, (GLsizei) payload[2],
+                                          (GLsizei) payload[3], payload[4]);
+        xglCountDraw(payload[1], payload[2], payload[3]);
+        break;
+      }
+      case RO_SCISSOR: {
+        GLfloat rect[4];
+        readRect(payload, rect);
+        const GLfloat * const parent = depth ? clips[depth - 1] : clip;
+        if (parent) { intersectRect(rect, parent); }
+        memcpy(clips[depth], rect, sizeof(rect));
+        applyClip(clips[depth], height);
+        break;
+      }
+      case RO_PUSH_CLIP: {
+        if (depth == XGL_CLIP_DEPTH) {
+          ignored++;
+          break;
+        }
+        readRect(payload, clips[depth + 1]);
+        intersectRect(clips[depth + 1], clips[depth]);
+        depth++;
+        applyClip(clips[depth], height);
+        break;
+      }
+      case RO_POP_CLIP: {
+        if (ignored) {
+          ignored--;
+          break;
+        }
+        if (depth == 0) { break; }
+        depth--;
+        applyClip(clips[depth], height);
+        break;
+      }
+    }
+  }
+  xglSetScissor(false);
+}
@@ -1,15 +1,76 @@
-/**
- * Project Name: xide
- * Module Name: runtime
- * Filename: context.h
- * Creator: Yaokai Liu
- * Create Date: 2024-11-14
- * Copyright (c) 2024 Yaokai Liu. All rights reserved.
- **/
-
-#ifndef XIDE_CONTEXT_H
-#define XIDE_CONTEXT_H
-
-#include "draw.h"
-
-#endif  // XIDE_CONTEXT_H
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: context.h
+ * Creator: Yaokai Liu
+ * Create Date: 2024-11-14
+ * Copyright (c) 2024 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_CONTEXT_H
+#define XIDE_CONTEXT_H
+
+#include "draw.h"
+
+// Render context is a linear buffer of recorded draw commands. Recording makes no
+// GL calls, so a context may be recorded on any thread, one thread per context, and
+// kept between frames while what it draws does not change. `xglContextReplay` then
+// executes it on the GL thread through the state cache.
+// Every command is a header word, `op | n_payload << 8`, followed by `n_payload`
+// words of arguments; floats are stored by their bits.
+
+enum RENDER_OP {
+  RO_PROGRAM = 1,         // program
+  RO_UNIFORM_1F = 2,      // location, value, to the program bound before
+  RO_UNIFORM_2F = 3,      // location, value[2], to the program bound before
+  RO_DRAW = 4,            // VAO, mode, polygon mode, count, index offset, base vertex
+  RO_DRAW_INSTANCED = 5,  // VAO, mode, count, instance count, base instance
+  RO_SCISSOR = 6,         // x0, y0, x1, y1, replacing clip rect of current level
+  RO_PUSH_CLIP = 7,       // x0, y0, x1, y1, intersected with clip rect of current level
+  RO_POP_CLIP = 8,
+};
+
+// Clips nested deeper than this at replay are ignored.
+#define XGL_CLIP_DEPTH 32
+
+typedef struct RenderContext {
+  const Allocator *allocator;
+  Array *words;  // Array<uint32_t>
+  uint32_t n_commands;
+  uint32_t clip_depth;  // pushes not popped yet
+} RenderContext;
+
+RenderContext *xglCreateRenderContext(const Allocator *allocator);
+void xglDestroyRenderContext(RenderContext *context);
+// Drop all recorded commands, keeping the buffer for next recording.
+void xglContextReset(RenderContext *context);
+
+void xglContextBindProgram(RenderContext *context, GLuint program);
+void xglContextUniform1f(RenderContext *context, GLint location, GLfloat value);
+void xglContextUniform2f(RenderContext *context, GLint location, const GLfloat value[2]);
+// Indexed draw of `count` indices from byte `index_offset` of element buffer of `VAO`.
+// `polygon_mode` only applies to GL_TRIANGLES.
+void xglContextDraw(RenderContext *context, GLuint VAO, GLenum mode, GLenum polygon_mode,
+                    GLsizei count, uintptr_t index_offset, GLint base_vertex);
+void xglContextDrawInstanced(RenderContext *context, GLuint VAO, GLenum mode, GLsizei count,
+                             GLsizei n_instances, GLuint base_instance);
+// Program, uniforms and draw of `task`, as `xglDraw` would issue them now. Geometry
+// of a dynamic task moves on every commit, so it must be recorded again after that.
+void xglContextDrawTask(RenderContext *context, const DrawTask *task);
+
+// Clip rects are x0, y0, x1, y1 in window pixels, like damage rects.
+void xglContextScissor(RenderContext *context, const GLfloat rect[4]);
+void xglContextPushClip(RenderContext *context, const GLfloat rect[4]);
+// Restore clip rect of the push before. Unbalanced pops are not recorded.
+void xglContextPopClip(RenderContext *context);
+
+// Append commands of `src`, e.g. a cached subtree recorded by another thread, to
+// `dest`. Clips left pushed by `src` are popped after them.
+void xglContextAppend(RenderContext *dest, const RenderContext *src);
+
+// Execute `context` on the GL thread. Clip rects are intersected with `clip`, or
+// with the whole framebuffer if it is nullptr, and flipped by `height` of the
+// framebuffer. Scissor test is left disabled.
+void xglContextReplay(const RenderContext *context, const GLfloat clip[4], GLsizei height);
+
+#endif  // XIDE_CONTEXT_H
@@ -0,0 +1,160 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: damage.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "damage.h"
+#include "view.h"
+#include <math.h>
+
+static DamageRegion CURRENT_DAMAGE = {.full = true};
+
+#define rect_area(_r) (((_r)[2] - (_r)[0]) * ((_r)[3] - (_r)[1]))
+
+static bool rectsTouch(const GLfloat a[4], const GLfloat b[4]) {
+  return a[0] <= b[2] && b[0] <= a[2] && a[1] <= b[3] && b[1] <= a[3];
+}
+
+static void unionRect(GLfloat into[4], const GLfloat rect[4]) {
+  into[0] = fminf(into[0], rect[0]);
+  into[1] = fminf(into[1], rect[1]);
+  into[2] = fmaxf(into[2], rect[2]);
+  into[3] = fmaxf(into[3], rect[3]);
+}
+
+// Merge rect `i` with every other rect it touches, until none is left.
+static void coalesce(DamageRegion * const region, uint32_t i) {
+  for (uint32_t j = 0; j < region->n_rects;) {
+    if (j == i || !rectsTouch(region->rects[i], region->rects[j])) {
+      j++;
+      continue;
+    }
+    unionRect(region->rects[i], region->rects[j]);
+    region->n_rects--;
+    if (j != region->n_rects) {
+      for (int k = 0; k < 4; k++) { region->rects[j][k] = region->rects[region->n_rects][k]; }
+    }
+    if (i == region->n_rects) { i = j; }
+    j = 0;
+  }
+}
+
+void xglDamageRegionAdd(DamageRegion * const region, const GLfloat rect[4]) {
+  if (region->full || rect[0] >= rect[2] || rect[1] >= rect[3]) { return; }
+  for (uint32_t i = 0; i < region->n_rects; i++) {
+    if (!rectsTouch(region->rects[i], rect)) { continue; }
+    unionRect(region->rects[i], rect);
+    coalesce(region, i);
+    return;
+  }
+  if (region->n_rects < XGL_DAMAGE_RECTS) {
+    for (int k = 0; k < 4; k++) { region->rects[region->n_rects][k] = rect[k]; }
+    region->n_rects++;
+    return;
+  }
+  uint32_t best = 0;
+  GLfloat best_growth = INFINITY;
+  for (uint32_t i = 0; i < region->n_rects; i++) {
+    GLfloat merged[4] = {region->rects[i][0], region->rects[i][1], region->rects[i][2],
+                         region->rects[i][3]};
+    unionRect(merged, rect);
+    const GLfloat growth = rect_area(merged) - rect_area(region->rects[i]);
+    if (growth < best_growth) {
+      best = i;
+      best_growth = growth;
+    }
+  }
+  unionRect(region->rects[best], rect);
+  coalesce(region, best);
+}
+
+void xglDamageRegionMerge(DamageRegion * const region, const DamageRegion * const other) {
+  if (other->full) {
+    region->full = true;
+    region->n_rects = 0;
+    return;
+  }
+  for (uint32_t i = 0; i < other->n_rects; i++) { xglDamageRegionAdd(region, other->rects[i]); }
+}
+
+inline void xglDamageRegionClear(DamageRegion * const region) {
+  region->n_rects = 0;
+  region->full = false;
+}
+
+inline bool xglDamageRegionEmpty(const DamageRegion * const region) {
+  return !region->full && region->n_rects == 0;
+}
+
+void xglDamageBounds(const GLfloat bounds[4], const bool screen) {
+  if (bounds[0] > bounds[2] || bounds[1] > bounds[3]) { return; }
+  const XGLViewState * const view = xglGetViewState();
+  const GLfloat scroll[2] = {screen ? 0 : view->scroll[0], screen ? 0 : view->scroll[1]};
+  const GLfloat zoom = screen ? 1.0f : view->zoom;
+  const GLfloat rect[4] = {
+    (bounds[0] - scroll[0]) * zoom - XGL_DAMAGE_PAD,
+    (bounds[1] - scroll[1]) * zoom - XGL_DAMAGE_PAD,
+    (bounds[2] - scroll[0]) * zoom + XGL_DAMAGE_PAD,
+    (bounds[3] - scroll[1]) * zoom + XGL_DAMAGE_PAD,
+  };
+  xglDamageRegionAdd(&CURRENT_DAMAGE, rect);
+}
+
+inline void xglDamageAll(void) {
+  CURRENT_DAMAGE.full = true;
+  CURRENT_DAMAGE.n_rects = 0;
+}
+
+inline DamageRegion *xglGetDamage(void) {
+  return &CURRENT_DAMAGE;
+}
+
+static void allocBackBuffer(BackBuffer * const buffer) {
+  glCreateRenderbuffers(1, &buffer->color);
+  glNamedRenderbufferStorageMultisample(buffer->color, buffer->samples, GL_RGBA8, buffer->width,
+                                        buffer->height);
+  glCreateRenderbuffers(1, &buffer->depth);
+  glNamedRenderbufferStorageMultisample(buffer->depth, buffer->samples, GL_DEPTH_COMPONENT24,
+                                        buffer->width, buffer->height);
+  glNamedFramebufferRenderbuffer(buffer->framebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                                 buffer->color);
+  glNamedFramebufferRenderbuffer(buffer->framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+                                 buffer->depth);
+}
+
+BackBuffer *xglCreateBackBuffer(const GLsizei width, const GLsizei height,
+                                const Allocator * const allocator) {
+  BackBuffer *buffer = allocator->calloc(1, sizeof(BackBuffer));
+  buffer->allocator = allocator;
+  buffer->width = width;
+  buffer->height = height;
+  glGetIntegerv(GL_SAMPLES, &buffer->samples);
+  glCreateFramebuffers(1, &buffer->framebuffer);
+  allocBackBuffer(buffer);
+  return buffer;
+}
+
+void xglDestroyBackBuffer(BackBuffer *buffer) {
+  glDeleteFramebuffers(1, &buffer->framebuffer);
+  glDeleteRenderbuffers(1, &buffer->color);
+  glDeleteRenderbuffers(1, &buffer->depth);
+  buffer->allocator->free(buffer);
+}
+
+void xglResizeBackBuffer(BackBuffer *buffer, const GLsizei width, const GLsizei height) {
+  if (buffer->width == width && buffer->height == height) { return; }
+  glDeleteRenderbuffers(1, &buffer->color);
+  glDeleteRenderbuffers(1, &buffer->depth);
+  buffer->width = width;
+  buffer->height = height;
+  allocBackBuffer(buffer);
+}
+
+void xglPresentBackBuffer(const BackBuffer *buffer) {
+  glBlitNamedFramebuffer(buffer->framebuffer, 0, 0, 0, buffer->width, buffer->height, 0, 0,
+                         buffer->width, buffer->height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
@@ -0,0 +1,64 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: damage.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_DAMAGE_H
+#define XIDE_DAMAGE_H
+
+#include "allocator.h"
+#include "glad/glad.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define XGL_DAMAGE_RECTS 8
+// Margin around damaged bounds, for strokes wider than one pixel and AA fringes.
+#define XGL_DAMAGE_PAD   2.0f
+
+// Part of the window to redraw in next frame, as a few rects in window pixels.
+// Overlapping rects are merged; past `XGL_DAMAGE_RECTS`, the new rect is merged
+// into the one whose area grows least.
+typedef struct DamageRegion {
+  GLfloat rects[XGL_DAMAGE_RECTS][4];  // x0, y0, x1, y1
+  uint32_t n_rects;
+  bool full;
+} DamageRegion;
+
+void xglDamageRegionAdd(DamageRegion *region, const GLfloat rect[4]);
+void xglDamageRegionMerge(DamageRegion *region, const DamageRegion *other);
+void xglDamageRegionClear(DamageRegion *region);
+bool xglDamageRegionEmpty(const DamageRegion *region);
+
+// Damage of the current GL context. `bounds` is x0, y0, x1, y1 before view
+// transform, as in `DrawTask::bounds`, or in window pixels if `screen`, as for
+// `TF_SCREEN` tasks; empty bounds are ignored.
+void xglDamageBounds(const GLfloat bounds[4], bool screen);
+void xglDamageAll(void);
+DamageRegion *xglGetDamage(void);
+
+// Offscreen colour and depth buffers, which frames are drawn into and then
+// copied to the window, so content outside damaged rects is kept between frames.
+// Samples follow the default framebuffer, so blit works with MSAA windows too.
+typedef struct BackBuffer {
+  GLuint framebuffer;
+  GLuint color;
+  GLuint depth;
+  GLsizei width;
+  GLsizei height;
+  GLint samples;
+  const Allocator *allocator;
+} BackBuffer;
+
+BackBuffer *xglCreateBackBuffer(GLsizei width, GLsizei height, const Allocator *allocator);
+void xglDestroyBackBuffer(BackBuffer *buffer);
+// Reallocate storage at new size. Content is lost, but the whole window is already
+// damaged by the view size change that caused resizing.
+void xglResizeBackBuffer(BackBuffer *buffer, GLsizei width, GLsizei height);
+// Copy content to the back buffer of the window.
+void xglPresentBackBuffer(const BackBuffer *buffer);
+
+#endif  // XIDE_DAMAGE_H
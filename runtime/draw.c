@@ -10,100 +10,397 @@
 #include "draw.h"
 #include "GLFW/glfw3.h"
 #include "cg2d.h"
+#include "damage.h"
 #include "glad/glad.h"
+#include "state.h"
+#include "trace.h"
 #include "utils.h"
+#include "view.h"
 #include "widgets.h"
 #include "xgl-object.h"
 #include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+static void emptyBounds(GLfloat bounds[4]) {
+  bounds[0] = bounds[1] = INFINITY;
+  bounds[2] = bounds[3] = -INFINITY;
+}
+
+static void unionBounds(GLfloat bounds[4], const GLfloat other[4]) {
+  bounds[0] = fminf(bounds[0], other[0]);
+  bounds[1] = fminf(bounds[1], other[1]);
+  bounds[2] = fmaxf(bounds[2], other[2]);
+  bounds[3] = fmaxf(bounds[3], other[3]);
+}
 
 inline DrawTask *xglCreateDrawTask(const Array * const vertex_array,
-                                   const Array * const color_array, const Array * const index_array,
+                                   const Array * const index_array, const int plane_index,
                                    const Allocator * const allocator) {
-  iXGLVao VAO = {};
-  glCreateVertexArrays(1, &VAO);
-  glEnableVertexArrayAttrib(VAO, LOC_VERTEX);
-  glEnableVertexArrayAttrib(VAO, LOC_COLOR);
-  glEnableVertexArrayAttrib(VAO, LOC_WINDOW_SIZE);
-
-  iXGLVbo VBOs[3] = {};
-  glCreateBuffers(3, VBOs);
-  glNamedBufferStorage(VBOs[0], Array_length(vertex_array) * (GLsizeiptr) sizeof(XGLCoord),
-                       Array_get(vertex_array, 0), 0);
-  glNamedBufferStorage(VBOs[1], Array_length(color_array) * (GLsizeiptr) sizeof(XGLColor),
-                       Array_get(color_array, 0), 0);
-  glNamedBufferStorage(VBOs[2], Array_length(index_array) * (GLsizeiptr) sizeof(GLint),
-                       Array_get(index_array, 0), 0);
-
-  glVertexArrayAttribBinding(VAO, LOC_VERTEX, 0);
-  glVertexArrayAttribFormat(VAO, LOC_VERTEX, sizeof(XGLCoord) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-                            0);
-  glVertexArrayVertexBuffer(VAO, 0, VBOs[0], 0, sizeof(XGLCoord));
-
-  glVertexArrayAttribBinding(VAO, LOC_COLOR, 1);
-  glVertexArrayAttribFormat(VAO, LOC_COLOR, sizeof(XGLColor) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-                            0);
-  glVertexArrayVertexBuffer(VAO, 1, VBOs[1], 0, sizeof(XGLColor));
-
-  glVertexArrayElementBuffer(VAO, VBOs[2]);
+  TRACE_ZONE("xglCreateDrawTask");
+  GeometryHeap * const heap = xglGetGeometryHeap();
+  HeapBlock vertex_block = {}, index_block = {};
+  if (!xglHeapUploadVertices(heap, vertex_array, &vertex_block)) { return nullptr; }
+  if (!xglHeapUploadIndices(heap, index_array, &index_block)) {
+    xglHeapFreeVertices(heap, &vertex_block);
+    return nullptr;
+  }
 
   DrawTask *task = allocator->calloc(1, sizeof(DrawTask));
-  task->VAO = VAO;
-  task->VBOs = Array_new(sizeof(iXGLVbo), allocator);
-  task->IBO = VBOs[2];
+  task->VAO = heap->VAO;
+  task->vertex_block = vertex_block;
+  task->index_block = index_block;
+  initSmallArray(&task->VBOs, allocator);
   task->n_index = (GLsizei) Array_length(index_array);
-  task->uniforms = Array_new(sizeof(iXGLVUniform), allocator);
+  task->depth = XGL_planeDepth(plane_index);
+  initSmallArray(&task->uniforms, allocator);
+
+  const XGLVertex * const vertices = Array_get(vertex_array, 0);
+  task->flags = TF_OPAQUE;
+  emptyBounds(task->bounds);
+  for (uint32_t i = 0; i < Array_length(vertex_array); i++) {
+    if (vertices[i].color[CAX_A] != 255) { task->flags &= ~TF_OPAQUE; }
+    const GLfloat point[4] = {
+      vertices[i].coord[AXIS_X], vertices[i].coord[AXIS_Y],
+      vertices[i].coord[AXIS_X], vertices[i].coord[AXIS_Y],
+    };
+    unionBounds(task->bounds, point);
+  }
 
-  Array_append(task->VBOs, VBOs, 2);
-  iXGLVUniform uniform = {uniform_type(US_2SCA, UD_INT), LOC_WINDOW_SIZE};
-  Array_append(task->uniforms, &uniform, 1);
+  const iXGLVUniform uniform = {uniform_type(US_1SCA, UD_FLOAT), LOC_PLANE_DEPTH};
+  SmallArray_append(&task->uniforms.head, &uniform, 1);
+  xglUpdateSortKey(task);
 
   return task;
 }
 
+DrawTask *xglCreateDynamicTask(const uint32_t task_type, const uint32_t max_vertices,
+                               const uint32_t max_indices, const int plane_index,
+                               const Allocator * const allocator) {
+  TRACE_ZONE("xglCreateDynamicTask");
+  StreamRing * const ring = xglGetStreamRing();
+  HeapBlock slot = {};
+  if (!xglRingAlloc(ring, max_vertices + xglRingIndexUnits(max_indices), &slot)) {
+    return nullptr;
+  }
+
+  DrawTask *task = allocator->calloc(1, sizeof(DrawTask));
+  task->task_type = task_type;
+  task->flags = TF_DYNAMIC;
+  task->VAO = ring->VAO;
+  task->vertex_block = (HeapBlock) {slot.offset, max_vertices};
+  task->index_block = (HeapBlock) {slot.offset + max_vertices, max_indices};
+  emptyBounds(task->bounds);
+  initSmallArray(&task->VBOs, allocator);
+  task->depth = XGL_planeDepth(plane_index);
+  initSmallArray(&task->uniforms, allocator);
+
+  const iXGLVUniform uniform = {uniform_type(US_1SCA, UD_FLOAT), LOC_PLANE_DEPTH};
+  SmallArray_append(&task->uniforms.head, &uniform, 1);
+  xglUpdateSortKey(task);
+
+  return task;
+}
+
+// Mapped address of `offset` in the region the next commit of dynamic `task` moves it
+// to, or nullptr while that region is read by a frame in flight. Frames reading it
+// were all published before the second last commit.
+static void *mapWritable(const DrawTask * const task, const uint32_t offset) {
+  StreamRing * const ring = xglGetStreamRing();
+  if (!xglRingFramesCompleted(ring, task->commit_frames[0])) { return nullptr; }
+  return xglRingMap(ring, (task->region + 1) % XGL_RING_FRAMES, offset);
+}
+
+inline XGLVertex *xglMapDynamicVertices(const DrawTask * const task) {
+  return mapWritable(task, task->vertex_block.offset);
+}
+
+inline GLuint *xglMapDynamicIndices(const DrawTask * const task) {
+  return mapWritable(task, task->index_block.offset);
+}
+
+void xglCommitDynamicTask(DrawTask * const task, const GLsizei n_index,
+                          const GLfloat bounds[4]) {
+  task->n_index = n_index;
+  task->region = (task->region + 1) % XGL_RING_FRAMES;
+  task->commit_frames[0] = task->commit_frames[1];
+  task->commit_frames[1] = xglGetStreamRing()->published;
+  const bool screen = task->flags & TF_SCREEN;
+  xglDamageBounds(task->bounds, screen);
+  for (int i = 0; i < 4; i++) { task->bounds[i] = bounds[i]; }
+  xglDamageBounds(task->bounds, screen);
+}
+
 inline void xglDestroyDrawTask(DrawTask * const task) {
-  const iXGLVbo *buffer = (iXGLVbo *) Array_get(task->VBOs, 0);
-  glDeleteBuffers((GLint) Array_length(task->VBOs), buffer);
-  glDeleteVertexArrays(1, &task->VAO);
+  if (task->flags & TF_DYNAMIC) {
+    const HeapBlock slot = {
+      task->vertex_block.offset,
+      task->vertex_block.count + (uint32_t) xglRingIndexUnits(task->index_block.count),
+    };
+    xglRingFree(xglGetStreamRing(), &slot);
+  } else if (task->task_type == TT_RECTS) {
+    xglHeapFreeInstances(xglGetGeometryHeap(), &task->vertex_block);
+  } else {
+    GeometryHeap * const heap = xglGetGeometryHeap();
+    xglHeapFreeVertices(heap, &task->vertex_block);
+    xglHeapFreeIndices(heap, &task->index_block);
+  }
+  const iXGLVbo *buffer = (iXGLVbo *) SmallArray_get(&task->VBOs.head, 0);
+  if (buffer) { glDeleteBuffers((GLint) SmallArray_length(&task->VBOs.head), buffer); }
 
-  releaseArray(task->VBOs);
-  releaseArray(task->uniforms);
+  SmallArray_reset(&task->VBOs.head, nullptr);
+  SmallArray_reset(&task->uniforms.head, nullptr);
 }
 
 void xglBindShaderProgram(DrawTask *task, GLuint program) {
   task->program = program;
+  xglUpdateSortKey(task);
+}
+
+// Order-preserving map of float to uint32_t.
+static uint32_t sortableDepth(const GLfloat depth) {
+  uint32_t bits;
+  memcpy(&bits, &depth, sizeof(bits));
+  return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+void xglUpdateSortKey(DrawTask *task) {
+  const uint64_t depth = sortableDepth(task->depth);
+  if (task->flags & TF_OPAQUE) {
+    // front-to-back, then grouped by state.
+    task->sort_key = depth << 32 | (uint64_t) (task->program & 0xFFFF) << 16 | (task->VAO & 0xFFFF);
+  } else {
+    // back-to-front; equal keys keep list order as sorting is stable.
+    task->sort_key = (uint64_t) (~depth & 0xFFFFFFFF) << 32;
+  }
+}
+
+// Convert `Vertex`es to `XGLVertex`es, and also to `XGLCoord`s for triangulation
+// if `coord_array` is not nullptr.
+static void convertVertices(const Array * const vertex_array, Array * const xgl_vertex_array,
+                            Array * const coord_array) {
+  const int count = (int) Array_length(vertex_array);
+  const Vertex * const vertices = Array_get(vertex_array, 0);
+  for (int i = 0; i < count; i++) {
+    XGLVertex vertex = {};
+    vertex.coord[AXIS_X] = vertices[i].coord[AXIS_X];
+    vertex.coord[AXIS_Y] = vertices[i].coord[AXIS_Y];
+    rgba2XGLColor8(vertices[i].color, &vertex.color);
+    Array_append(xgl_vertex_array, &vertex, 1);
+    if (coord_array) {
+      XGLCoord coord = {};
+      coord[AXIS_X] = vertices[i].coord[AXIS_X];
+      coord[AXIS_Y] = vertices[i].coord[AXIS_Y];
+      Array_append(coord_array, coord, 1);
+    }
+  }
+}
+
+static enum XGL_AA_MODE AA_MODE = AA_MSAA;
+static GLfloat STROKE_WIDTH = 1.0f;
+
+#define MITER_LIMIT 4.0f
+
+inline void xglSetAntiAliasMode(const enum XGL_AA_MODE mode) {
+  AA_MODE = mode;
+}
+
+inline enum XGL_AA_MODE xglGetAntiAliasMode(void) {
+  return AA_MODE;
+}
+
+void xglSetStrokeWidth(const GLfloat width) {
+  STROKE_WIDTH = width;
+  if (AA_MODE == AA_MSAA) { glLineWidth(width); }
+}
+
+// Size of one screen pixel in world units at the current zoom, as in vert-default.glsl.
+static GLfloat pixelSize(void) {
+  const GLfloat zoom = xglGetViewState()->zoom;
+  return zoom > 0 ? 1.0f / zoom : 1.0f;
+}
+
+// Outward unit normal of edge `a`->`b` of a triangle whose third vertex is `c`.
+static void edgeNormal(const GLfloat *a, const GLfloat *b, const GLfloat *c, GLfloat normal[2]) {
+  const GLfloat dx = b[AXIS_X] - a[AXIS_X], dy = b[AXIS_Y] - a[AXIS_Y];
+  const GLfloat length = sqrtf(dx * dx + dy * dy);
+  normal[AXIS_X] = length > 0 ? dy / length : 0;
+  normal[AXIS_Y] = length > 0 ? -dx / length : 0;
+  const GLfloat side = (c[AXIS_X] - a[AXIS_X]) * normal[AXIS_X]
+                       + (c[AXIS_Y] - a[AXIS_Y]) * normal[AXIS_Y];
+  if (side > 0) {
+    normal[AXIS_X] = -normal[AXIS_X];
+    normal[AXIS_Y] = -normal[AXIS_Y];
+  }
+}
+
+// Add a one-pixel fringe around triangles of `index_array`: boundary vertices are
+// moved half a pixel inwards, and copies of them half a pixel outwards, with alpha 0,
+// are joined to them by two triangles per boundary edge.
+static void featherArea(Array * const vertex_array, Array * const index_array,
+                        const Allocator * const allocator) {
+  const uint32_t n_vertices = Array_length(vertex_array);
+  const uint32_t n_edges = Array_length(index_array) / 3 * 3;
+  if (n_edges == 0) { return; }
+  const GLint * const indices = Array_get(index_array, 0);
+  uint64_t * const keys = allocator->malloc(sizeof(uint64_t) * n_edges);
+  uint32_t * const order = allocator->malloc(sizeof(uint32_t) * n_edges);
+  GLfloat (* const normals)[2] = allocator->calloc(n_vertices, sizeof(*normals));
+  GLint * const outer = allocator->malloc(sizeof(GLint) * n_vertices);
+  if (!keys || !order || !normals || !outer) { goto __feather_failed; }
+
+  // Edges used by only one triangle are on boundary; find them by sorting.
+  for (uint32_t e = 0; e < n_edges; e++) {
+    const uint64_t a = (uint32_t) indices[e];
+    const uint64_t b = (uint32_t) indices[e - e % 3 + (e + 1) % 3];
+    keys[e] = a < b ? a << 32 | b : b << 32 | a;
+    order[e] = e;
+  }
+  if (!radixSortU64(keys, order, n_edges, allocator)) { goto __feather_failed; }
+  uint32_t n_boundary = 0;
+  for (uint32_t i = 0; i < n_edges; i++) {
+    if ((i > 0 && keys[i] == keys[i - 1]) || (i + 1 < n_edges && keys[i] == keys[i + 1])) {
+      continue;
+    }
+    order[n_boundary++] = order[i];
+  }
+
+  const XGLVertex *vertices = Array_get(vertex_array, 0);
+  for (uint32_t i = 0; i < n_boundary; i++) {
+    const uint32_t e = order[i], base = e - e % 3;
+    const GLint a = indices[e], b = indices[base + (e + 1) % 3], c = indices[base + (e + 2) % 3];
+    GLfloat normal[2];
+    edgeNormal(vertices[a].coord, vertices[b].coord, vertices[c].coord, normal);
+    for (int axis = AXIS_X; axis <= AXIS_Y; axis++) {
+      normals[a][axis] += normal[axis];
+      normals[b][axis] += normal[axis];
+    }
+  }
+
+  // Sum `s` of two unit normals gives the miter `2s / |s|^2`, one pixel across.
+  const GLfloat pixel = pixelSize();
+  for (uint32_t v = 0; v < n_vertices; v++) {
+    const GLfloat length2 = normals[v][AXIS_X] * normals[v][AXIS_X]
+                            + normals[v][AXIS_Y] * normals[v][AXIS_Y];
+    outer[v] = -1;
+    if (length2 == 0) { continue; }
+    GLfloat scale = 2.0f / length2;
+    if (scale * sqrtf(length2) > MITER_LIMIT) { scale = MITER_LIMIT / sqrtf(length2); }
+    XGLVertex fringe = *(const XGLVertex *) Array_get(vertex_array, v);
+    XGLVertex * const inner = Array_get(vertex_array, v);
+    for (int axis = AXIS_X; axis <= AXIS_Y; axis++) {
+      const GLfloat offset = 0.5f * pixel * scale * normals[v][axis];
+      inner->coord[axis] -= offset;
+      fringe.coord[axis] += offset;
+    }
+    fringe.color[CAX_A] = 0;
+    outer[v] = (GLint) Array_length(vertex_array);
+    Array_append(vertex_array, &fringe, 1);
+  }
+
+  for (uint32_t i = 0; i < n_boundary; i++) {
+    const GLint * const triangles = Array_get(index_array, 0);
+    const uint32_t e = order[i];
+    const GLint a = triangles[e], b = triangles[e - e % 3 + (e + 1) % 3];
+    const GLint quad[6] = {a, b, outer[b], a, outer[b], outer[a]};
+    Array_append(index_array, quad, 6);
+  }
+
+__feather_failed:
+  allocator->free(keys);
+  allocator->free(order);
+  allocator->free(normals);
+  allocator->free(outer);
+}
+
+// Replace segments of `index_array` (pairs of vertices) by quads `STROKE_WIDTH` wide,
+// each with a one-pixel fringe of alpha 0 along both sides.
+static void featherStrokes(Array * const vertex_array, Array * const index_array,
+                           const Allocator * const allocator) {
+  Array * const points = Array_new(sizeof(XGLVertex), allocator);
+  Array * const segments = Array_new(sizeof(GLint), allocator);
+  Array_append(points, Array_get(vertex_array, 0), Array_length(vertex_array));
+  Array_append(segments, Array_get(index_array, 0), Array_length(index_array));
+  Array_clear(vertex_array, nullptr);
+  Array_clear(index_array, nullptr);
+
+  // Widths are in pixels, as of `glLineWidth` in MSAA mode.
+  const GLfloat pixel = pixelSize();
+  const GLfloat half = STROKE_WIDTH * 0.5f * pixel, fringe = 0.5f * pixel;
+  const GLfloat inner = half > fringe ? half - fringe : 0.0f;
+  const GLfloat offsets[4] = {-half - fringe, -inner, inner, half + fringe};
+  const uint32_t n_segments = Array_length(segments) / 2;
+  const GLint * const ends = Array_get(segments, 0);
+  const XGLVertex * const vertices = Array_get(points, 0);
+  for (uint32_t i = 0; i < n_segments; i++) {
+    const XGLVertex * const a = &vertices[ends[2 * i]], * const b = &vertices[ends[2 * i + 1]];
+    const GLfloat dx = b->coord[AXIS_X] - a->coord[AXIS_X];
+    const GLfloat dy = b->coord[AXIS_Y] - a->coord[AXIS_Y];
+    const GLfloat length = sqrtf(dx * dx + dy * dy);
+    if (length == 0) { continue; }
+    const GLfloat nx = -dy / length, ny = dx / length;
+    const GLint base = (GLint) Array_length(vertex_array);
+    for (int end = 0; end < 2; end++) {
+      for (int j = 0; j < 4; j++) {
+        XGLVertex vertex = end ? *b : *a;
+        vertex.coord[AXIS_X] += nx * offsets[j];
+        vertex.coord[AXIS_Y] += ny * offsets[j];
+        if (j == 0 || j == 3) { vertex.color[CAX_A] = 0; }
+        Array_append(vertex_array, &vertex, 1);
+      }
+    }
+    for (GLint j = 0; j < 3; j++) {
+      const GLint quad[6] = {
+        base + j, base + 4 + j, base + 5 + j, base + j, base + 5 + j, base + 1 + j,
+      };
+      Array_append(index_array, quad, 6);
+    }
+  }
+
+  releaseArray(points);
+  releaseArray(segments);
+}
+
+// Anti-alias geometry of a solid area in current mode.
+static void antiAliasArea(Array * const vertex_array, Array * const index_array, const bool solid,
+                          const Allocator * const allocator) {
+  if (AA_MODE == AA_ANALYTIC && solid) { featherArea(vertex_array, index_array, allocator); }
+}
+
+// Anti-alias geometry of strokes in current mode, and return the task type to draw
+// them with: strokes become triangles in analytic mode.
+static uint32_t antiAliasStrokes(Array * const vertex_array, Array * const index_array,
+                                 const uint32_t task_type, const Allocator * const allocator) {
+  if (AA_MODE != AA_ANALYTIC) { return task_type; }
+  featherStrokes(vertex_array, index_array, allocator);
+  return TT_SOLID_AREA;
 }
 
 DrawTask *xglCreatePixelLines(const Array * const line_array, const int plane_index,
                               const Allocator * const allocator) {
+  TRACE_ZONE("xglCreatePixelLines");
   const int count = (int) Array_length(line_array);
   const Line * const lines = Array_get(line_array, 0);
-  Array *vertex_array = Array_new(sizeof(XGLCoord), allocator);
-  Array *color_array = Array_new(sizeof(XGLColor), allocator);
+  Array *vertex_array = Array_new(sizeof(XGLVertex), allocator);
   Array *index_array = Array_new(sizeof(GLint), allocator);
   for (int i = 0; i < count; i++) {
-    XGLCoord vertices[2] = {};
-    XGLColor colors[2] = {};
+    XGLVertex vertices[2] = {};
     GLint indices[2] = {2 * i, 2 * i + 1};
-    rgba2XGLColor(lines[i][0].color, &colors[0]);
-    rgba2XGLColor(lines[i][1].color, &colors[1]);
-    vertices[VERTEX_BEGIN][AXIS_X] = (float) lines[i][0].coord[AXIS_X];
-    vertices[VERTEX_BEGIN][AXIS_Y] = (float) lines[i][0].coord[AXIS_Y];
-    vertices[VERTEX_BEGIN][AXIS_Z] = atanf((float) plane_index) * 100.0f;
-    vertices[VERTEX_BEGIN][AXIS_W] = 0.0f;
-    vertices[VERTEX_END][AXIS_X] = (float) lines[i][1].coord[AXIS_X];
-    vertices[VERTEX_END][AXIS_Y] = (float) lines[i][1].coord[AXIS_Y];
-    vertices[VERTEX_END][AXIS_Z] = atanf((float) plane_index) * 100.0f;
-    vertices[VERTEX_END][AXIS_W] = 0.0f;
+    rgba2XGLColor8(lines[i][0].color, &vertices[VERTEX_BEGIN].color);
+    rgba2XGLColor8(lines[i][1].color, &vertices[VERTEX_END].color);
+    vertices[VERTEX_BEGIN].coord[AXIS_X] = (float) lines[i][0].coord[AXIS_X];
+    vertices[VERTEX_BEGIN].coord[AXIS_Y] = (float) lines[i][0].coord[AXIS_Y];
+    vertices[VERTEX_END].coord[AXIS_X] = (float) lines[i][1].coord[AXIS_X];
+    vertices[VERTEX_END].coord[AXIS_Y] = (float) lines[i][1].coord[AXIS_Y];
     Array_append(vertex_array, vertices, 2);
-    Array_append(color_array, colors, 2);
     Array_append(index_array, indices, 2);
   }
 
-  DrawTask * const task = xglCreateDrawTask(vertex_array, color_array, index_array, allocator);
-  task->task_type = TT_LINES;
+  const uint32_t task_type = antiAliasStrokes(vertex_array, index_array, TT_LINES, allocator);
+  DrawTask * const task = xglCreateDrawTask(vertex_array, index_array, plane_index, allocator);
+  if (task) { task->task_type = task_type; }
 
   releaseArray(vertex_array);
-  releaseArray(color_array);
   releaseArray(index_array);
 
   return task;
@@ -111,28 +408,18 @@ DrawTask *xglCreatePixelLines(const Array * const line_array, const int plane_in
 
 DrawTask *xglCreatePolygon2D(const Array * const vertex_array, const int plane_index,
                              const bool solid, const Allocator * const allocator) {
-  const int count = (int) Array_length(vertex_array);
-  const Vertex * const vertices = Array_get(vertex_array, 0);
+  TRACE_ZONE("xglCreatePolygon2D");
+  Array *xgl_vertex_array = Array_new(sizeof(XGLVertex), allocator);
   Array *coord_array = Array_new(sizeof(XGLCoord), allocator);
-  Array *color_array = Array_new(sizeof(XGLColor), allocator);
-  for (int i = 0; i < count; i++) {
-    XGLCoord vertex = {};
-    XGLColor color = {};
-    rgba2XGLColor(vertices[i].color, &color);
-    vertex[AXIS_X] = vertices[i].coord[AXIS_X];
-    vertex[AXIS_Y] = vertices[i].coord[AXIS_Y];
-    vertex[AXIS_Z] = atanf((float) plane_index) * 100.0f;
-    vertex[AXIS_W] = 0.0f;
-    Array_append(coord_array, vertex, 1);
-    Array_append(color_array, color, 1);
-  }
+  convertVertices(vertex_array, xgl_vertex_array, coord_array);
   Array *index_array = xglEarClippingTriangulate2D(coord_array, allocator);
 
-  DrawTask * const task = xglCreateDrawTask(coord_array, color_array, index_array, allocator);
-  task->task_type = solid ? TT_SOLID_AREA : TT_TRIANGULATED_AREA;
+  antiAliasArea(xgl_vertex_array, index_array, solid, allocator);
+  DrawTask * const task = xglCreateDrawTask(xgl_vertex_array, index_array, plane_index, allocator);
+  if (task) { task->task_type = solid ? TT_SOLID_AREA : TT_TRIANGULATED_AREA; }
 
+  releaseArray(xgl_vertex_array);
   releaseArray(coord_array);
-  releaseArray(color_array);
   releaseArray(index_array);
 
   return task;
@@ -141,28 +428,18 @@ DrawTask *xglCreatePolygon2D(const Array * const vertex_array, const int plane_i
 DrawTask *xglCreateCurveArea2D(const Array * const vertex_array, const int plane_index,
                                const bool cycle, const bool solid,
                                const Allocator * const allocator) {
-  const int count = (int) Array_length(vertex_array);
-  const Vertex * const vertices = Array_get(vertex_array, 0);
+  TRACE_ZONE("xglCreateCurveArea2D");
+  Array *xgl_vertex_array = Array_new(sizeof(XGLVertex), allocator);
   Array *coord_array = Array_new(sizeof(XGLCoord), allocator);
-  Array *color_array = Array_new(sizeof(XGLColor), allocator);
-  for (int i = 0; i < count; i++) {
-    XGLCoord vertex = {};
-    XGLColor color = {};
-    rgba2XGLColor(vertices[i].color, &color);
-    vertex[AXIS_X] = vertices[i].coord[AXIS_X];
-    vertex[AXIS_Y] = vertices[i].coord[AXIS_Y];
-    vertex[AXIS_Z] = atanf((float) plane_index) * 100.0f;
-    vertex[AXIS_W] = 0.0f;
-    Array_append(coord_array, vertex, 1);
-    Array_append(color_array, color, 1);
-  }
+  convertVertices(vertex_array, xgl_vertex_array, coord_array);
   Array *index_array = xglRadialTriangulation2D(coord_array, cycle, allocator);
 
-  DrawTask * const task = xglCreateDrawTask(coord_array, color_array, index_array, allocator);
-  task->task_type = solid ? TT_SOLID_AREA : TT_TRIANGULATED_AREA;
+  antiAliasArea(xgl_vertex_array, index_array, solid, allocator);
+  DrawTask * const task = xglCreateDrawTask(xgl_vertex_array, index_array, plane_index, allocator);
+  if (task) { task->task_type = solid ? TT_SOLID_AREA : TT_TRIANGULATED_AREA; }
 
+  releaseArray(xgl_vertex_array);
   releaseArray(coord_array);
-  releaseArray(color_array);
   releaseArray(index_array);
 
   return task;
@@ -170,28 +447,18 @@ DrawTask *xglCreateCurveArea2D(const Array * const vertex_array, const int plane
 
 DrawTask *xglCreatePixelPolygon(const Array * const vertex_array, int plane_index, bool solid,
                                 const Allocator *allocator) {
-  const int count = (int) Array_length(vertex_array);
-  const Vertex * const vertices = Array_get(vertex_array, 0);
+  TRACE_ZONE("xglCreatePixelPolygon");
+  Array *xgl_vertex_array = Array_new(sizeof(XGLVertex), allocator);
   Array *coord_array = Array_new(sizeof(XGLCoord), allocator);
-  Array *color_array = Array_new(sizeof(XGLColor), allocator);
-  for (int i = 0; i < count; i++) {
-    XGLCoord vertex = {};
-    XGLColor color = {};
-    rgba2XGLColor(vertices[i].color, &color);
-    vertex[AXIS_X] = (float) vertices[i].coord[AXIS_X];
-    vertex[AXIS_Y] = (float) vertices[i].coord[AXIS_Y];
-    vertex[AXIS_Z] = atanf((float) plane_index) * 100.0f;
-    vertex[AXIS_W] = 0.0f;
-    Array_append(coord_array, vertex, 1);
-    Array_append(color_array, color, 1);
-  }
+  convertVertices(vertex_array, xgl_vertex_array, coord_array);
   Array *index_array = xglEarClippingTriangulate2D(coord_array, allocator);
 
-  DrawTask * const task = xglCreateDrawTask(coord_array, color_array, index_array, allocator);
-  task->task_type = solid ? TT_SOLID_AREA : TT_TRIANGULATED_AREA;
+  antiAliasArea(xgl_vertex_array, index_array, solid, allocator);
+  DrawTask * const task = xglCreateDrawTask(xgl_vertex_array, index_array, plane_index, allocator);
+  if (task) { task->task_type = solid ? TT_SOLID_AREA : TT_TRIANGULATED_AREA; }
 
+  releaseArray(xgl_vertex_array);
   releaseArray(coord_array);
-  releaseArray(color_array);
   releaseArray(index_array);
 
   return task;
@@ -199,22 +466,11 @@ DrawTask *xglCreatePixelPolygon(const Array * const vertex_array, int plane_inde
 
 DrawTask *xglCreatePolyline2D(const Array * const vertex_array, const int plane_index,
                               const bool cycle, const Allocator * const allocator) {
+  TRACE_ZONE("xglCreatePolyline2D");
   const int count = (int) Array_length(vertex_array);
-  const Vertex * const vertices = Array_get(vertex_array, 0);
-  Array *coord_array = Array_new(sizeof(XGLCoord), allocator);
-  Array *color_array = Array_new(sizeof(XGLColor), allocator);
+  Array *xgl_vertex_array = Array_new(sizeof(XGLVertex), allocator);
   Array *index_array = Array_new(sizeof(GLint), allocator);
-  for (int i = 0; i < count; i++) {
-    XGLCoord vertex = {};
-    XGLColor color = {};
-    rgba2XGLColor(vertices[i].color, &color);
-    vertex[AXIS_X] = vertices[i].coord[AXIS_X];
-    vertex[AXIS_Y] = vertices[i].coord[AXIS_Y];
-    vertex[AXIS_Z] = atanf((float) plane_index) * 100.0f;
-    vertex[AXIS_W] = 0.0f;
-    Array_append(coord_array, vertex, 1);
-    Array_append(color_array, color, 1);
-  }
+  convertVertices(vertex_array, xgl_vertex_array, nullptr);
   for (int i = 0; i < count - 1; i++) {
     int indices[2] = {i, i + 1};
     Array_append(index_array, indices, 2);
@@ -224,11 +480,12 @@ DrawTask *xglCreatePolyline2D(const Array * const vertex_array, const int plane_
     Array_append(index_array, indices, 2);
   }
 
-  DrawTask * const task = xglCreateDrawTask(coord_array, color_array, index_array, allocator);
-  task->task_type = TT_POLYLINE;
+  const uint32_t task_type =
+      antiAliasStrokes(xgl_vertex_array, index_array, TT_POLYLINE, allocator);
+  DrawTask * const task = xglCreateDrawTask(xgl_vertex_array, index_array, plane_index, allocator);
+  if (task) { task->task_type = task_type; }
 
-  releaseArray(coord_array);
-  releaseArray(color_array);
+  releaseArray(xgl_vertex_array);
   releaseArray(index_array);
 
   return task;
@@ -236,22 +493,11 @@ DrawTask *xglCreatePolyline2D(const Array * const vertex_array, const int plane_
 
 DrawTask *xglCreatePixelPolyline(const Array * const vertex_array, int plane_index, bool cycle,
                                  const Allocator *allocator) {
+  TRACE_ZONE("xglCreatePixelPolyline");
   const int count = (int) Array_length(vertex_array);
-  const Vertex * const vertices = Array_get(vertex_array, 0);
-  Array *coord_array = Array_new(sizeof(XGLCoord), allocator);
-  Array *color_array = Array_new(sizeof(XGLColor), allocator);
+  Array *xgl_vertex_array = Array_new(sizeof(XGLVertex), allocator);
   Array *index_array = Array_new(sizeof(GLint), allocator);
-  for (int i = 0; i < count; i++) {
-    XGLCoord vertex = {};
-    XGLColor color = {};
-    rgba2XGLColor(vertices[i].color, &color);
-    vertex[AXIS_X] = (float) vertices[i].coord[AXIS_X];
-    vertex[AXIS_Y] = (float) vertices[i].coord[AXIS_Y];
-    vertex[AXIS_Z] = atanf((float) plane_index) * 100.0f;
-    vertex[AXIS_W] = 0.0f;
-    Array_append(coord_array, vertex, 1);
-    Array_append(color_array, color, 1);
-  }
+  convertVertices(vertex_array, xgl_vertex_array, nullptr);
   for (int i = 0; i < count - 1; i++) {
     int indices[2] = {i, i + 1};
     Array_append(index_array, indices, 2);
@@ -261,66 +507,145 @@ DrawTask *xglCreatePixelPolyline(const Array * const vertex_array, int plane_ind
     Array_append(index_array, indices, 2);
   }
 
-  DrawTask * const task = xglCreateDrawTask(coord_array, color_array, index_array, allocator);
-  task->task_type = TT_POLYLINE;
+  const uint32_t task_type =
+      antiAliasStrokes(xgl_vertex_array, index_array, TT_POLYLINE, allocator);
+  DrawTask * const task = xglCreateDrawTask(xgl_vertex_array, index_array, plane_index, allocator);
+  if (task) { task->task_type = task_type; }
 
-  releaseArray(coord_array);
-  releaseArray(color_array);
+  releaseArray(xgl_vertex_array);
   releaseArray(index_array);
 
   return task;
 }
 
-inline void xglDrawLines(const DrawTask * const task, const GLfloat viewportSize[2]) {
-  glUseProgram(task->program);
-  glBindVertexArray(task->VAO);
-  for (uint32_t i = 0; i < Array_length(task->uniforms); i++) {
-    iXGLVUniform *uniform = (iXGLVUniform *) Array_get(task->uniforms, i);
-    glProgramUniform2fv(task->program, uniform->u_locate, 1, viewportSize);
+DrawTask *xglCreateRects(const Array * const rect_array, const int plane_index,
+                         const Allocator * const allocator) {
+  TRACE_ZONE("xglCreateRects");
+  GeometryHeap * const heap = xglGetGeometryHeap();
+  HeapBlock instance_block = {};
+  if (!xglHeapUploadInstances(heap, rect_array, &instance_block)) { return nullptr; }
+
+  DrawTask *task = allocator->calloc(1, sizeof(DrawTask));
+  task->task_type = TT_RECTS;
+  task->VAO = heap->rect_VAO;
+  task->vertex_block = instance_block;
+  task->n_index = 4;  // corners of the unit quad
+  emptyBounds(task->bounds);
+  const XGLRect * const rects = Array_get(rect_array, 0);
+  for (uint32_t i = 0; i < Array_length(rect_array); i++) {
+    const GLfloat rect[4] = {
+      rects[i].rect[0], rects[i].rect[1],
+      rects[i].rect[0] + rects[i].rect[2], rects[i].rect[1] + rects[i].rect[3],
+    };
+    unionBounds(task->bounds, rect);
   }
-  glDrawElements(GL_LINES, task->n_index, GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
+  initSmallArray(&task->VBOs, allocator);
+  task->depth = XGL_planeDepth(plane_index);
+  initSmallArray(&task->uniforms, allocator);
+
+  const iXGLVUniform uniform = {uniform_type(US_1SCA, UD_FLOAT), LOC_PLANE_DEPTH};
+  SmallArray_append(&task->uniforms.head, &uniform, 1);
+  xglUpdateSortKey(task);
+
+  return task;
 }
 
-inline void xglDrawArea(const DrawTask * const task, const GLfloat viewportSize[2]) {
-  glUseProgram(task->program);
-  glBindVertexArray(task->VAO);
-  if (task->task_type == TT_SOLID_AREA) {
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-  } else {
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+void xglTaskModes(const DrawTask * const task, GLenum * const mode, GLenum * const polygon_mode) {
+  *polygon_mode = GL_FILL;
+  switch (task->task_type) {
+    case TT_LINES: *mode = GL_LINES; break;
+    case TT_POLYLINE: *mode = GL_LINE_STRIP; break;
+    case TT_TRIANGULATED_AREA: *polygon_mode = GL_LINE;  // fallthrough
+    case TT_SOLID_AREA: *mode = GL_TRIANGLES; break;
+    case TT_RECTS: *mode = GL_TRIANGLE_STRIP; break;
+    default: *mode = GL_NONE;
   }
-  for (uint32_t i = 0; i < Array_length(task->uniforms); i++) {
-    iXGLVUniform *uniform = (iXGLVUniform *) Array_get(task->uniforms, i);
-    glProgramUniform2fv(task->program, uniform->u_locate, 1, viewportSize);
+}
+
+// Dynamic tasks address the stream ring region they were last committed to, in units
+// of XGLVertex; static ones address the geometry heap arenas.
+GLint xglTaskBaseVertex(const DrawTask * const task) {
+  if (!(task->flags & TF_DYNAMIC)) { return (GLint) task->vertex_block.offset; }
+  const uint32_t base = xglRingRegionBase(xglGetStreamRing(), task->region);
+  return (GLint) (base + task->vertex_block.offset);
+}
+
+const void *xglTaskIndexOffset(const DrawTask * const task) {
+  if (!(task->flags & TF_DYNAMIC)) {
+    return (const void *) ((uintptr_t) task->index_block.offset * sizeof(GLuint));
   }
-  glDrawElements(GL_TRIANGLES, task->n_index, GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
+  const uint32_t base = xglRingRegionBase(xglGetStreamRing(), task->region);
+  return (const void *) ((uintptr_t) (base + task->index_block.offset) * sizeof(XGLVertex));
 }
 
-inline void xglDrawPolyline(const DrawTask * const task, const GLfloat viewportSize[2]) {
-  glUseProgram(task->program);
-  glBindVertexArray(task->VAO);
-  for (uint32_t i = 0; i < Array_length(task->uniforms); i++) {
-    iXGLVUniform *uniform = (iXGLVUniform *) Array_get(task->uniforms, i);
-    glProgramUniform2fv(task->program, uniform->u_locate, 1, viewportSize);
+void xglUploadUniforms(const DrawTask * const task) {
+  for (uint32_t i = 0; i < SmallArray_length(&task->uniforms.head); i++) {
+    iXGLVUniform *uniform = (iXGLVUniform *) SmallArray_get(&task->uniforms.head, i);
+    switch (uniform->u_locate) {
+      case LOC_PLANE_DEPTH: {
+        xglProgramUniform1f(task->program, uniform->u_locate, task->depth);
+        break;
+      }
+      default: {
+      }
+    }
   }
-  glDrawElements(GL_LINE_STRIP, task->n_index, GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
 }
 
-inline void xglDraw(const DrawTask * const task, const IdeWindow * const window) {
-  const float * const viewSize = &window->viewport[2];
+inline void xglDrawLines(const DrawTask * const task) {
+  xglUseProgram(task->program);
+  xglBindVertexArray(task->VAO);
+  xglUploadUniforms(task);
+  glDrawElementsBaseVertex(GL_LINES, task->n_index, GL_UNSIGNED_INT, xglTaskIndexOffset(task),
+                           xglTaskBaseVertex(task));
+  xglCountDraw(GL_LINES, task->n_index, 1);
+}
+
+inline void xglDrawArea(const DrawTask * const task) {
+  xglUseProgram(task->program);
+  xglBindVertexArray(task->VAO);
+  xglPolygonMode(task->task_type == TT_SOLID_AREA ? GL_FILL : GL_LINE);
+  xglUploadUniforms(task);
+  glDrawElementsBaseVertex(GL_TRIANGLES, task->n_index, GL_UNSIGNED_INT, xglTaskIndexOffset(task),
+                           xglTaskBaseVertex(task));
+  xglCountDraw(GL_TRIANGLES, task->n_index, 1);
+}
+
+inline void xglDrawPolyline(const DrawTask * const task) {
+  xglUseProgram(task->program);
+  xglBindVertexArray(task->VAO);
+  xglUploadUniforms(task);
+  glDrawElementsBaseVertex(GL_LINE_STRIP, task->n_index, GL_UNSIGNED_INT, xglTaskIndexOffset(task),
+                           xglTaskBaseVertex(task));
+  xglCountDraw(GL_LINE_STRIP, task->n_index, 1);
+}
+
+inline void xglDrawRects(const DrawTask * const task) {
+  if (task->vertex_block.count == 0) { return; }
+  xglUseProgram(task->program);
+  xglBindVertexArray(task->VAO);
+  xglPolygonMode(GL_FILL);
+  xglUploadUniforms(task);
+  glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, task->n_index,
+                                    (GLsizei) task->vertex_block.count,
+                                    task->vertex_block.offset);
+  xglCountDraw(GL_TRIANGLE_STRIP, task->n_index, task->vertex_block.count);
+}
+
+inline void xglDraw(const DrawTask * const task) {
   switch (task->task_type) {
     case TT_LINES: {
-      return xglDrawLines(task, viewSize);
+      return xglDrawLines(task);
     }
     case TT_POLYLINE: {
-      return xglDrawPolyline(task, viewSize);
+      return xglDrawPolyline(task);
     }
     case TT_SOLID_AREA:
     case TT_TRIANGULATED_AREA: {
-      return xglDrawArea(task, viewSize);
+      return xglDrawArea(task);
+    }
+    case TT_RECTS: {
+      return xglDrawRects(task);
     }
   }
 }
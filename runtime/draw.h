@@ -11,6 +11,8 @@
 #define XIDE_DRAW_H
 
 #include "array.h"
+#include "heap.h"
+#include "ring.h"
 #include "widgets.h"
 #include "xgl-object.h"
 
@@ -19,22 +21,80 @@ enum TASK_TYPE_ENUM {
   TT_SOLID_AREA = 2,
   TT_TRIANGULATED_AREA = 3,
   TT_POLYLINE = 4,
+  // Instanced rectangles; `vertex_block` is the block of XGLRect instances.
+  TT_RECTS = 5,
 };
 
+enum XGL_AA_MODE {
+  // Edges are anti-aliased by a multisampled framebuffer.
+  AA_MSAA = 0,
+  // Solid areas get a one-pixel feathered fringe and strokes become feathered
+  // quads, with coverage in vertex alpha, so a single-sample framebuffer is enough.
+  AA_ANALYTIC = 1,
+};
+
+enum TASK_FLAG {
+  // Every vertex is fully opaque, so task is drawn in the depth-tested opaque pass.
+  TF_OPAQUE = 1 << 0,
+  // Geometry is in a slot of the stream ring and may be rewritten every frame.
+  TF_DYNAMIC = 1 << 1,
+  // Task is kept in the task list but not drawn.
+  TF_HIDDEN = 1 << 2,
+  // Geometry is in window pixels and ignores scroll and zoom, e.g. overlays.
+  TF_SCREEN = 1 << 3,
+};
+
+// Opaque tasks are drawn front-to-back by (plane, program, VAO) with depth test,
+// then blended tasks back-to-front by plane. Only blended tasks of one plane keep
+// their list order, so opaque tasks that overlap should be on different planes.
+// Dynamic tasks are drawn after both, in list order.
 typedef struct DrawTask {
   uint32_t task_type;
-  iXGLVao VAO;
+  uint32_t flags;  // enum TASK_FLAG
+  uint64_t sort_key;  // cached by `xglUpdateSortKey`
+  iXGLVao VAO;  // of the geometry heap or stream ring, not owned by task
   iXGLshProg program;
-  iXGLIbo IBO;
+  HeapBlock vertex_block;  // in stream ring units for dynamic tasks
+  HeapBlock index_block;   // in stream ring units for dynamic tasks
   GLsizei n_index;
-  Array *VBOs;  // Array<iXGLVbo>
-  Array *uniforms;  // Array<iXGLVUniform>
+  uint32_t region;  // stream ring region last committed, for dynamic tasks
+  uint64_t commit_frames[2];  // frames of the two last commits, for dynamic tasks
+  GLfloat depth;
+  GLfloat bounds[4];  // x0, y0, x1, y1 of geometry, before view transform
+  SmallArrayOf(iXGLVbo, 2) VBOs;  // buffers owned by task, besides the geometry heap
+  SmallArrayOf(iXGLVUniform, 1) uniforms;
 } DrawTask;
 
-DrawTask *xglCreateDrawTask(const Array *vertex_array, const Array *color_array,
-                            const Array *index_array, const Allocator *allocator);
+// `vertex_array` is Array<XGLVertex> and `index_array` is Array<GLint>, both are
+// uploaded into the current geometry heap. Indices are relative to the first vertex.
+// Return nullptr if geometry heap could not hold them.
+DrawTask *xglCreateDrawTask(const Array *vertex_array, const Array *index_array, int plane_index,
+                            const Allocator *allocator);
 void xglDestroyDrawTask(DrawTask *task);
 
+// Dynamic task of `task_type` holding at most `max_vertices` vertices and `max_indices`
+// indices in the current stream ring. Return nullptr if stream ring is full.
+DrawTask *xglCreateDynamicTask(uint32_t task_type, uint32_t max_vertices, uint32_t max_indices,
+                               int plane_index, const Allocator *allocator);
+// Mapped memory of dynamic `task` in the region its next commit moves it to. Whole
+// geometry must be rewritten and then committed, as other regions hold older
+// geometry. While a frame in flight still reads that region, nullptr is returned
+// instead of blocking; skip the update then and try again on a later tick.
+XGLVertex *xglMapDynamicVertices(const DrawTask *task);
+GLuint *xglMapDynamicIndices(const DrawTask *task);
+// Draw `n_index` indices written since map from the frame being built on, which is
+// the one published next. Both old and new `bounds` (x0, y0, x1, y1) are damaged,
+// so only they are redrawn.
+void xglCommitDynamicTask(DrawTask *task, GLsizei n_index, const GLfloat bounds[4]);
+
+// Anti-aliasing mode and stroke width of tasks created from now on. Geometry of
+// dynamic tasks is written by their owners, and is never feathered.
+// Fringes and stroke widths are in pixels at the zoom of the view when a task is
+// created, so tasks should be created again once zoom changes much.
+void xglSetAntiAliasMode(enum XGL_AA_MODE mode);
+enum XGL_AA_MODE xglGetAntiAliasMode(void);
+void xglSetStrokeWidth(GLfloat width);
+
 DrawTask *xglCreatePolygon2D(const Array *vertex_array, int plane_index, bool solid,
                              const Allocator *allocator);
 DrawTask *xglCreateCurveArea2D(const Array *vertex_array, int plane_index, bool cycle, bool solid,
@@ -47,12 +107,29 @@ DrawTask *xglCreatePixelPolygon(const Array *vertex_array, int plane_index, bool
                                 const Allocator *allocator);
 DrawTask *xglCreatePixelPolyline(const Array *vertex_array, int plane_index, bool cycle,
                                  const Allocator *allocator);
+// `rect_array` is Array<XGLRect>, drawn by one instanced draw call with a program
+// built from shader/vert-rect.glsl and shader/frag-rect.glsl. Rectangles are
+// anti-aliased by blending, so they are always drawn in the blended pass.
+DrawTask *xglCreateRects(const Array *rect_array, int plane_index, const Allocator *allocator);
 
 void xglBindShaderProgram(DrawTask *task, GLuint program);
+// Recompute `task->sort_key` after changing its program, VAO, depth or flags.
+void xglUpdateSortKey(DrawTask *task);
+// Upload values of `task->uniforms` to `task->program`. View state shared by all
+// tasks is in the `ViewState` uniform block instead, see view.h.
+void xglUploadUniforms(const DrawTask *task);
+
+// Primitive and polygon mode `task` is drawn with; `mode` is GL_NONE for unknown types.
+void xglTaskModes(const DrawTask *task, GLenum *mode, GLenum *polygon_mode);
+// Base vertex and index buffer offset of `task`, in the region last committed for
+// dynamic tasks.
+GLint xglTaskBaseVertex(const DrawTask *task);
+const void *xglTaskIndexOffset(const DrawTask *task);
 
-void xglDrawLines(const DrawTask *task, const GLfloat viewportSize[2]);
-void xglDrawArea(const DrawTask *task, const GLfloat viewportSize[2]);
-void xglDrawPolyline(const DrawTask *task, const GLfloat viewportSize[2]);
-void xglDraw(const DrawTask *task, const IdeWindow *window);
+void xglDrawLines(const DrawTask *task);
+void xglDrawArea(const DrawTask *task);
+void xglDrawPolyline(const DrawTask *task);
+void xglDrawRects(const DrawTask *task);
+void xglDraw(const DrawTask *task);
 
 #endif  // XIDE_DRAW_H
@@ -0,0 +1,158 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: gpu-timer.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "gpu-timer.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct FrameQueries {
+  GLuint elapsed;
+  // Timestamp `i` starts category `categories[i]`; the one after the last ends it.
+  GLuint marks[XGL_GPU_TIMER_MARKS + 1];
+  uint8_t categories[XGL_GPU_TIMER_MARKS];
+  uint32_t n_marks;
+  bool pending;
+} FrameQueries;
+
+static struct {
+  bool active;
+  FrameQueries frames[XGL_GPU_TIMER_LAG];
+  uint32_t current;
+  uint32_t category;
+  pthread_mutex_t lock;  // guards fields below
+  // Rolling history in nanoseconds, frame time first, then categories.
+  uint64_t history[1 + XGL_GPU_CATEGORIES][XGL_GPU_TIMER_HISTORY];
+  uint32_t n_history;
+  uint32_t head;
+  uint64_t last;
+  uint64_t n_frames;
+  uint64_t n_dropped;
+} GPU_TIMER = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+void xglInitGpuTimer(void) {
+  if (GPU_TIMER.active) { return; }
+  for (uint32_t i = 0; i < XGL_GPU_TIMER_LAG; i++) {
+    FrameQueries * const frame = &GPU_TIMER.frames[i];
+    glCreateQueries(GL_TIME_ELAPSED, 1, &frame->elapsed);
+    glCreateQueries(GL_TIMESTAMP, XGL_GPU_TIMER_MARKS + 1, frame->marks);
+    frame->n_marks = 0;
+    frame->pending = false;
+  }
+  GPU_TIMER.current = 0;
+  GPU_TIMER.active = true;
+}
+
+void xglReleaseGpuTimer(void) {
+  if (!GPU_TIMER.active) { return; }
+  for (uint32_t i = 0; i < XGL_GPU_TIMER_LAG; i++) {
+    FrameQueries * const frame = &GPU_TIMER.frames[i];
+    glDeleteQueries(1, &frame->elapsed);
+    glDeleteQueries(XGL_GPU_TIMER_MARKS + 1, frame->marks);
+  }
+  GPU_TIMER.active = false;
+}
+
+// Result of `frame` into the history, or false if GPU has not finished it yet.
+static bool readFrame(const FrameQueries * const frame) {
+  GLint available = 0;
+  glGetQueryObjectiv(frame->elapsed, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available) { return false; }
+  glGetQueryObjectiv(frame->marks[frame->n_marks], GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available) { return false; }
+
+  uint64_t times[1 + XGL_GPU_CATEGORIES] = {};
+  glGetQueryObjectui64v(frame->elapsed, GL_QUERY_RESULT, &times[0]);
+  GLuint64 start;
+  glGetQueryObjectui64v(frame->marks[0], GL_QUERY_RESULT, &start);
+  for (uint32_t i = 0; i < frame->n_marks; i++) {
+    GLuint64 end;
+    glGetQueryObjectui64v(frame->marks[i + 1], GL_QUERY_RESULT, &end);
+    times[1 + frame->categories[i]] += end - start;
+    start = end;
+  }
+
+  pthread_mutex_lock(&GPU_TIMER.lock);
+  for (uint32_t i = 0; i < 1 + XGL_GPU_CATEGORIES; i++) {
+    GPU_TIMER.history[i][GPU_TIMER.head] = times[i];
+  }
+  GPU_TIMER.head = (GPU_TIMER.head + 1) % XGL_GPU_TIMER_HISTORY;
+  if (GPU_TIMER.n_history < XGL_GPU_TIMER_HISTORY) { GPU_TIMER.n_history++; }
+  GPU_TIMER.last = times[0];
+  GPU_TIMER.n_frames++;
+  pthread_mutex_unlock(&GPU_TIMER.lock);
+  return true;
+}
+
+void xglGpuFrameBegin(void) {
+  if (!GPU_TIMER.active) { return; }
+  FrameQueries * const frame = &GPU_TIMER.frames[GPU_TIMER.current];
+  if (frame->pending && !readFrame(frame)) {
+    pthread_mutex_lock(&GPU_TIMER.lock);
+    GPU_TIMER.n_dropped++;
+    pthread_mutex_unlock(&GPU_TIMER.lock);
+  }
+  frame->pending = false;
+  frame->n_marks = 0;
+  GPU_TIMER.category = UINT32_MAX;
+  glBeginQuery(GL_TIME_ELAPSED, frame->elapsed);
+  xglGpuMark(GC_OTHER);
+}
+
+void xglGpuMark(const uint32_t category) {
+  if (!GPU_TIMER.active || category == GPU_TIMER.category) { return; }
+  FrameQueries * const frame = &GPU_TIMER.frames[GPU_TIMER.current];
+  if (frame->n_marks == XGL_GPU_TIMER_MARKS || category >= XGL_GPU_CATEGORIES) { return; }
+  glQueryCounter(frame->marks[frame->n_marks], GL_TIMESTAMP);
+  frame->categories[frame->n_marks++] = (uint8_t) category;
+  GPU_TIMER.category = category;
+}
+
+void xglGpuFrameEnd(void) {
+  if (!GPU_TIMER.active) { return; }
+  FrameQueries * const frame = &GPU_TIMER.frames[GPU_TIMER.current];
+  glQueryCounter(frame->marks[frame->n_marks], GL_TIMESTAMP);
+  glEndQuery(GL_TIME_ELAPSED);
+  frame->pending = true;
+  GPU_TIMER.current = (GPU_TIMER.current + 1) % XGL_GPU_TIMER_LAG;
+}
+
+static int compareU64(const void *a, const void *b) {
+  const uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+static void summarize(const uint64_t * const history, const uint32_t n, XGLGpuTimes * const times) {
+  memset(times, 0, sizeof(XGLGpuTimes));
+  if (n == 0) { return; }
+  uint64_t sorted[XGL_GPU_TIMER_HISTORY];
+  memcpy(sorted, history, n * sizeof(uint64_t));
+  qsort(sorted, n, sizeof(uint64_t), compareU64);
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < n; i++) { sum += sorted[i]; }
+  times->mean = (double) sum / n * 1e-6;
+  times->p50 = (double) sorted[(n - 1) * 50 / 100] * 1e-6;
+  times->p95 = (double) sorted[(n - 1) * 95 / 100] * 1e-6;
+  times->p99 = (double) sorted[(n - 1) * 99 / 100] * 1e-6;
+  times->max = (double) sorted[n - 1] * 1e-6;
+}
+
+void xglGpuTimerStats(XGLGpuStats *stats) {
+  pthread_mutex_lock(&GPU_TIMER.lock);
+  const uint32_t n = GPU_TIMER.n_history;
+  stats->frames = GPU_TIMER.n_frames;
+  stats->dropped = GPU_TIMER.n_dropped;
+  stats->history = n;
+  stats->last = (double) GPU_TIMER.last * 1e-6;
+  summarize(GPU_TIMER.history[0], n, &stats->frame);
+  for (uint32_t i = 0; i < XGL_GPU_CATEGORIES; i++) {
+    summarize(GPU_TIMER.history[1 + i], n, &stats->categories[i]);
+  }
+  pthread_mutex_unlock(&GPU_TIMER.lock);
+}
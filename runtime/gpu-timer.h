@@ -0,0 +1,60 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: gpu-timer.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_GPU_TIMER_H
+#define XIDE_GPU_TIMER_H
+
+#include "draw.h"
+
+// GPU time of whole frames by a `GL_TIME_ELAPSED` query, and of task categories by
+// `GL_TIMESTAMP` queries issued where the category being drawn changes. Queries of a
+// frame are read back `XGL_GPU_TIMER_LAG` frames later, so reading never stalls.
+// Recording belongs to the GL thread; stats may be read from any thread.
+
+#define XGL_GPU_TIMER_LAG     4
+// Category changes timed per frame; draws after that are counted in the last one.
+#define XGL_GPU_TIMER_MARKS   128
+// Frames kept for rolling averages and percentiles.
+#define XGL_GPU_TIMER_HISTORY 120
+
+// Categories are task types; clears, blits and anything not a task are `GC_OTHER`.
+#define GC_OTHER 0
+#define XGL_GPU_CATEGORIES (TT_RECTS + 1)
+
+// Milliseconds per frame over the history.
+typedef struct XGLGpuTimes {
+  double mean;
+  double p50;
+  double p95;
+  double p99;
+  double max;
+} XGLGpuTimes;
+
+typedef struct XGLGpuStats {
+  uint64_t frames;   // read back since init
+  uint64_t dropped;  // whose queries were not ready when their slot was reused
+  uint32_t history;  // frames in the rolling window
+  double last;       // milliseconds of the frame read back last
+  XGLGpuTimes frame;
+  XGLGpuTimes categories[XGL_GPU_CATEGORIES];
+} XGLGpuStats;
+
+// Create queries in the current GL context.
+void xglInitGpuTimer(void);
+void xglReleaseGpuTimer(void);
+
+// Read back the frame `XGL_GPU_TIMER_LAG` frames ago, then start timing a frame.
+void xglGpuFrameBegin(void);
+// GPU work issued from now on belongs to `category`.
+void xglGpuMark(uint32_t category);
+void xglGpuFrameEnd(void);
+
+void xglGpuTimerStats(XGLGpuStats *stats);
+
+#endif  // XIDE_GPU_TIMER_H
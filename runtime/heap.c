@@ -0,0 +1,227 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: heap.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "heap.h"
+#include "state.h"
+#include <stddef.h>
+
+#define HEAP_VERTICES (1 << 16)
+#define HEAP_INDICES  (3 << 16)
+#define HEAP_RECTS    (1 << 12)
+
+static GeometryHeap *CURRENT_GEOMETRY_HEAP = nullptr;
+
+static iXGLVbo createArenaBuffer(const uint32_t capacity, const uint32_t ele_size) {
+  iXGLVbo buffer = 0;
+  glCreateBuffers(1, &buffer);
+  glNamedBufferStorage(buffer, (GLsizeiptr) capacity * ele_size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+  return buffer;
+}
+
+static void initArena(GeometryArena * const arena, const uint32_t capacity,
+                      const uint32_t ele_size, const Allocator * const allocator) {
+  arena->ele_size = ele_size;
+  arena->capacity = capacity;
+  arena->buffer = createArenaBuffer(capacity, ele_size);
+  arena->free_list = Array_new(sizeof(HeapBlock), allocator);
+  const HeapBlock whole = {0, capacity};
+  Array_append(arena->free_list, &whole, 1);
+}
+
+bool xglBlockAlloc(Array * const free_list, const uint32_t count, HeapBlock * const block) {
+  const uint32_t n_blocks = Array_length(free_list);
+  HeapBlock * const blocks = Array_get(free_list, 0);
+  for (uint32_t i = 0; i < n_blocks; i++) {
+    if (blocks[i].count < count) { continue; }
+    block->offset = blocks[i].offset;
+    block->count = count;
+    blocks[i].offset += count;
+    blocks[i].count -= count;
+    if (blocks[i].count == 0) { Array_remove(free_list, i, 1); }
+    return true;
+  }
+  return false;
+}
+
+void xglBlockFree(Array * const free_list, const HeapBlock * const block) {
+  if (block->count == 0) { return; }
+  const uint32_t n_blocks = Array_length(free_list);
+  HeapBlock * const blocks = Array_get(free_list, 0);
+  uint32_t i = 0;
+  while (i < n_blocks && blocks[i].offset < block->offset) { i++; }
+  const bool merge_prev = i > 0 && blocks[i - 1].offset + blocks[i - 1].count == block->offset;
+  const bool merge_next = i < n_blocks && block->offset + block->count == blocks[i].offset;
+  if (merge_prev && merge_next) {
+    blocks[i - 1].count += block->count + blocks[i].count;
+    Array_remove(free_list, i, 1);
+  } else if (merge_prev) {
+    blocks[i - 1].count += block->count;
+  } else if (merge_next) {
+    blocks[i].offset = block->offset;
+    blocks[i].count += block->count;
+  } else {
+    Array_insert(free_list, i, block, 1);
+  }
+}
+
+// Grow arena to hold at least `count` more elements in one block. Offsets of
+// allocated blocks stay valid: old content is copied to the head of the new buffer.
+static bool growArena(GeometryArena * const arena, const uint32_t count) {
+  uint64_t capacity = (uint64_t) arena->capacity * 2;
+  while (capacity < (uint64_t) arena->capacity + count) { capacity *= 2; }
+  if (capacity * arena->ele_size > INT32_MAX) { return false; }
+  const iXGLVbo buffer = createArenaBuffer((uint32_t) capacity, arena->ele_size);
+  glCopyNamedBufferSubData(arena->buffer, buffer, 0, 0,
+                           (GLsizeiptr) arena->capacity * arena->ele_size);
+  glDeleteBuffers(1, &arena->buffer);
+  arena->buffer = buffer;
+  const HeapBlock tail = {arena->capacity, (uint32_t) capacity - arena->capacity};
+  arena->capacity = (uint32_t) capacity;
+  xglBlockFree(arena->free_list, &tail);
+  return true;
+}
+
+static bool arenaUpload(GeometryArena * const arena, const Array * const array,
+                        HeapBlock * const block, bool * const grown) {
+  const uint32_t count = Array_length(array);
+  block->offset = 0;
+  block->count = count;
+  if (count == 0) { return true; }
+  while (!xglBlockAlloc(arena->free_list, count, block)) {
+    if (!growArena(arena, count)) { return false; }
+    *grown = true;
+  }
+  glNamedBufferSubData(arena->buffer, (GLintptr) block->offset * arena->ele_size,
+                       (GLsizeiptr) count * arena->ele_size, Array_get(array, 0));
+  xglCountUpload((uint64_t) count * arena->ele_size);
+  return true;
+}
+
+static void bindHeapBuffers(const GeometryHeap * const heap) {
+  glVertexArrayVertexBuffer(heap->VAO, 0, heap->vertices.buffer, 0, sizeof(XGLVertex));
+  glVertexArrayElementBuffer(heap->VAO, heap->indices.buffer);
+  glVertexArrayVertexBuffer(heap->rect_VAO, 1, heap->instances.buffer, 0, sizeof(XGLRect));
+}
+
+static void initRectVAO(GeometryHeap * const heap) {
+  static const GLfloat corners[4][2] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+  glCreateBuffers(1, &heap->quad);
+  glNamedBufferStorage(heap->quad, sizeof(corners), corners, 0);
+
+  const iXGLVao VAO = heap->rect_VAO;
+  glVertexArrayVertexBuffer(VAO, 0, heap->quad, 0, sizeof(corners[0]));
+  glEnableVertexArrayAttrib(VAO, LOC_VERTEX);
+  glVertexArrayAttribBinding(VAO, LOC_VERTEX, 0);
+  glVertexArrayAttribFormat(VAO, LOC_VERTEX, 2, GL_FLOAT, GL_FALSE, 0);
+
+  glVertexArrayBindingDivisor(VAO, 1, 1);
+  const struct {
+    GLuint location;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLuint offset;
+  } attribs[] = {
+    {LOC_RECT, 4, GL_FLOAT, GL_FALSE, offsetof(XGLRect, rect)},
+    {LOC_RADII, 4, GL_UNSIGNED_BYTE, GL_FALSE, offsetof(XGLRect, radii)},
+    {LOC_BORDER_WIDTH, 1, GL_FLOAT, GL_FALSE, offsetof(XGLRect, border_width)},
+    {LOC_FILL_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(XGLRect, fill)},
+    {LOC_BORDER_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(XGLRect, border)},
+  };
+  for (size_t i = 0; i < sizeof(attribs) / sizeof(attribs[0]); i++) {
+    glEnableVertexArrayAttrib(VAO, attribs[i].location);
+    glVertexArrayAttribBinding(VAO, attribs[i].location, 1);
+    glVertexArrayAttribFormat(VAO, attribs[i].location, attribs[i].size, attribs[i].type,
+                              attribs[i].normalized, attribs[i].offset);
+  }
+}
+
+GeometryHeap *xglCreateGeometryHeap(const uint32_t n_vertices, const uint32_t n_indices,
+                                    const Allocator * const allocator) {
+  GeometryHeap *heap = allocator->calloc(1, sizeof(GeometryHeap));
+  heap->allocator = allocator;
+  initArena(&heap->vertices, n_vertices, sizeof(XGLVertex), allocator);
+  initArena(&heap->indices, n_indices, sizeof(GLuint), allocator);
+  initArena(&heap->instances, HEAP_RECTS, sizeof(XGLRect), allocator);
+
+  glCreateVertexArrays(1, &heap->VAO);
+  glEnableVertexArrayAttrib(heap->VAO, LOC_VERTEX);
+  glEnableVertexArrayAttrib(heap->VAO, LOC_COLOR);
+  glVertexArrayAttribBinding(heap->VAO, LOC_VERTEX, 0);
+  glVertexArrayAttribFormat(heap->VAO, LOC_VERTEX, 2, GL_FLOAT, GL_FALSE,
+                            offsetof(XGLVertex, coord));
+  glVertexArrayAttribBinding(heap->VAO, LOC_COLOR, 0);
+  glVertexArrayAttribFormat(heap->VAO, LOC_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                            offsetof(XGLVertex, color));
+  glCreateVertexArrays(1, &heap->rect_VAO);
+  initRectVAO(heap);
+  bindHeapBuffers(heap);
+  return heap;
+}
+
+void xglDestroyGeometryHeap(GeometryHeap *heap) {
+  glDeleteVertexArrays(1, &heap->VAO);
+  glDeleteBuffers(1, &heap->vertices.buffer);
+  glDeleteBuffers(1, &heap->indices.buffer);
+  glDeleteVertexArrays(1, &heap->rect_VAO);
+  glDeleteBuffers(1, &heap->quad);
+  glDeleteBuffers(1, &heap->instances.buffer);
+  releaseArray(heap->vertices.free_list);
+  releaseArray(heap->indices.free_list);
+  releaseArray(heap->instances.free_list);
+  heap->allocator->free(heap);
+}
+
+bool xglHeapUploadVertices(GeometryHeap *heap, const Array *vertex_array, HeapBlock *block) {
+  bool grown = false;
+  const bool ok = arenaUpload(&heap->vertices, vertex_array, block, &grown);
+  if (grown) { bindHeapBuffers(heap); }
+  return ok;
+}
+
+bool xglHeapUploadIndices(GeometryHeap *heap, const Array *index_array, HeapBlock *block) {
+  bool grown = false;
+  const bool ok = arenaUpload(&heap->indices, index_array, block, &grown);
+  if (grown) { bindHeapBuffers(heap); }
+  return ok;
+}
+
+bool xglHeapUploadInstances(GeometryHeap *heap, const Array *rect_array, HeapBlock *block) {
+  bool grown = false;
+  const bool ok = arenaUpload(&heap->instances, rect_array, block, &grown);
+  if (grown) { bindHeapBuffers(heap); }
+  return ok;
+}
+
+void xglHeapFreeVertices(GeometryHeap *heap, const HeapBlock *block) {
+  xglBlockFree(heap->vertices.free_list, block);
+}
+
+void xglHeapFreeIndices(GeometryHeap *heap, const HeapBlock *block) {
+  xglBlockFree(heap->indices.free_list, block);
+}
+
+void xglHeapFreeInstances(GeometryHeap *heap, const HeapBlock *block) {
+  xglBlockFree(heap->instances.free_list, block);
+}
+
+void xglInitGeometryHeap(const Allocator *allocator) {
+  if (CURRENT_GEOMETRY_HEAP) { return; }
+  CURRENT_GEOMETRY_HEAP = xglCreateGeometryHeap(HEAP_VERTICES, HEAP_INDICES, allocator);
+}
+
+inline GeometryHeap *xglGetGeometryHeap(void) {
+  return CURRENT_GEOMETRY_HEAP;
+}
+
+void xglReleaseGeometryHeap(void) {
+  if (!CURRENT_GEOMETRY_HEAP) { return; }
+  xglDestroyGeometryHeap(CURRENT_GEOMETRY_HEAP);
+  CURRENT_GEOMETRY_HEAP = nullptr;
+}
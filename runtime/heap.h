@@ -0,0 +1,73 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: heap.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_HEAP_H
+#define XIDE_HEAP_H
+
+#include "array.h"
+#include "xgl-object.h"
+
+// Range of a geometry heap buffer, in elements of the buffer.
+typedef struct HeapBlock {
+  uint32_t offset;
+  uint32_t count;
+} HeapBlock;
+
+// First-fit take `count` elements from `free_list` (Array<HeapBlock>, sorted by
+// offset and coalesced). Return false if no free block is large enough.
+bool xglBlockAlloc(Array *free_list, uint32_t count, HeapBlock *block);
+// Give `block` back to `free_list`, merging it with its neighbours.
+void xglBlockFree(Array *free_list, const HeapBlock *block);
+
+// One large immutable GL buffer, sub-allocated by a first-fit free list.
+typedef struct GeometryArena {
+  iXGLVbo buffer;
+  uint32_t ele_size;
+  uint32_t capacity;
+  Array *free_list;  // Array<HeapBlock>, sorted by offset and coalesced
+} GeometryArena;
+
+// Geometry of every static draw task lives in one vertex arena and one index
+// arena, so a single VAO serves every task that uses `XGLVertex`. Tasks keep
+// offsets (base vertex and first index) instead of buffer names.
+// Rectangle tasks share one unit quad and keep their `XGLRect`s in the instance
+// arena, addressed by base instance through `rect_VAO`.
+typedef struct GeometryHeap {
+  GeometryArena vertices;  // of XGLVertex
+  GeometryArena indices;   // of GLuint
+  GeometryArena instances;  // of XGLRect
+  iXGLVao VAO;
+  iXGLVbo quad;
+  iXGLVao rect_VAO;
+  const Allocator *allocator;
+} GeometryHeap;
+
+GeometryHeap *xglCreateGeometryHeap(uint32_t n_vertices, uint32_t n_indices,
+                                    const Allocator *allocator);
+void xglDestroyGeometryHeap(GeometryHeap *heap);
+
+// Upload all elements of `vertex_array` (Array<XGLVertex>) into heap, growing it
+// when needed. Return false if heap could not grow.
+bool xglHeapUploadVertices(GeometryHeap *heap, const Array *vertex_array, HeapBlock *block);
+// Upload all elements of `index_array` (Array<GLint>) into heap, growing it
+// when needed. Return false if heap could not grow.
+bool xglHeapUploadIndices(GeometryHeap *heap, const Array *index_array, HeapBlock *block);
+// Upload all elements of `rect_array` (Array<XGLRect>) into heap, growing it
+// when needed. Return false if heap could not grow.
+bool xglHeapUploadInstances(GeometryHeap *heap, const Array *rect_array, HeapBlock *block);
+void xglHeapFreeVertices(GeometryHeap *heap, const HeapBlock *block);
+void xglHeapFreeIndices(GeometryHeap *heap, const HeapBlock *block);
+void xglHeapFreeInstances(GeometryHeap *heap, const HeapBlock *block);
+
+// Geometry heap of the current GL context, used by `xglCreateDrawTask`.
+void xglInitGeometryHeap(const Allocator *allocator);
+GeometryHeap *xglGetGeometryHeap(void);
+void xglReleaseGeometryHeap(void);
+
+#endif  // XIDE_HEAP_H
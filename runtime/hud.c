@@ -0,0 +1,188 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: hud.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "hud.h"
+#include "runtime.h"
+#include "utils.h"
+#include <stdio.h>
+
+#define HUD_PLANE 8
+#define HUD_X     8.0f
+#define HUD_Y     40.0f
+// Graph is inset in the panel, one pixel per series per sample.
+#define GRAPH_INSET  8.0f
+#define GRAPH_WIDTH  (2.0f * HUD_SAMPLES)
+#define GRAPH_HEIGHT 64.0f
+// Time at the top of the graph, two frames of 60 Hz; a line marks one frame.
+#define GRAPH_MS     (2000.0f / 60.0f)
+#define FRAME_MS     (1000.0f / 60.0f)
+// Quads of both series and the frame line.
+#define GRAPH_QUADS  (2 * HUD_SAMPLES + 1)
+#define TITLE_INTERVAL 0.5
+
+static void graphRect(GLfloat rect[4]) {
+  rect[0] = HUD_X + GRAPH_INSET;
+  rect[1] = HUD_Y + GRAPH_INSET;
+  rect[2] = rect[0] + GRAPH_WIDTH;
+  rect[3] = rect[1] + GRAPH_HEIGHT;
+}
+
+static void writeQuad(XGLVertex * const vertices, GLuint * const indices, const uint32_t n,
+                      const GLfloat x0, const GLfloat y0, const GLfloat x1, const GLfloat y1,
+                      const uint32_t rgba) {
+  const GLfloat corners[4][2] = {{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+  for (uint32_t i = 0; i < 4; i++) {
+    vertices[4 * n + i].coord[AXIS_X] = corners[i][AXIS_X];
+    vertices[4 * n + i].coord[AXIS_Y] = corners[i][AXIS_Y];
+    rgba2XGLColor8(rgba, &vertices[4 * n + i].color);
+  }
+  const GLuint quad[6] = {0, 1, 2, 0, 2, 3};
+  for (uint32_t i = 0; i < 6; i++) { indices[6 * n + i] = 4 * n + quad[i]; }
+}
+
+static GLfloat barHeight(const GLfloat ms) {
+  return (ms < GRAPH_MS ? ms : GRAPH_MS) / GRAPH_MS * GRAPH_HEIGHT;
+}
+
+// Rewrite graph from oldest sample at the left to newest at the right.
+static void writeGraph(IdeWindow * const window, const PerfHud * const hud) {
+  DrawTask * const graph = ideWindowGetTask(window, hud->graph);
+  XGLVertex * const vertices = xglMapDynamicVertices(graph);
+  GLuint * const indices = xglMapDynamicIndices(graph);
+  // Samples are kept, so a graph skipped while frames are in flight is drawn next tick.
+  if (!vertices || !indices) { return; }
+  GLfloat rect[4];
+  graphRect(rect);
+
+  uint32_t n_quads = 0;
+  const uint32_t first = (hud->head + HUD_SAMPLES - hud->n_samples) % HUD_SAMPLES;
+  for (uint32_t i = 0; i < hud->n_samples; i++) {
+    const uint32_t sample = (first + i) % HUD_SAMPLES;
+    const GLfloat x = rect[0] + 2.0f * (GLfloat) (HUD_SAMPLES - hud->n_samples + i);
+    writeQuad(vertices, indices, n_quads++, x, rect[3] - barHeight(hud->cpu_ms[sample]), x + 1,
+              rect[3], 0x3399FFE0);
+    writeQuad(vertices, indices, n_quads++, x + 1, rect[3] - barHeight(hud->gpu_ms[sample]),
+              x + 2, rect[3], 0xFF9933E0);
+  }
+  const GLfloat frame_y = rect[3] - barHeight(FRAME_MS);
+  writeQuad(vertices, indices, n_quads++, rect[0], frame_y, rect[2], frame_y + 1, 0x66CC66FF);
+  xglCommitDynamicTask(graph, (GLsizei) (6 * n_quads), rect);
+}
+
+static void updateTitle(IdeWindow * const window, PerfHud * const hud,
+                        const RenderFrameStats * const stats, const double now) {
+  AllocatorStats allocs;
+  CountingAllocator_stats(&allocs);
+  const uint64_t frames = stats->frames - hud->title_frame;
+  const double fps = (double) frames / (now - hud->title_time);
+  const double allocs_per_frame =
+      frames ? (double) (allocs.allocations - hud->title_allocs.allocations) / (double) frames : 0;
+  const uint32_t latest = (hud->head + HUD_SAMPLES - 1) % HUD_SAMPLES;
+
+  char title[256];
+  snprintf(title, sizeof(title),
+           "%s | %.1f fps | cpu %.2f ms | gpu %.2f ms | %u draws | %u states | %llu tris"
+           " | %.1f KB up | %.1f allocs/frame",
+           hud->title, fps, hud->cpu_ms[latest], hud->gpu_ms[latest], stats->state.draws,
+           stats->state.issued, (unsigned long long) stats->state.triangles,
+           (double) stats->state.uploaded / 1024.0, allocs_per_frame);
+  glfwSetWindowTitle(window->info.handle, title);
+
+  hud->title_time = now;
+  hud->title_frame = stats->frames;
+  hud->title_allocs = allocs;
+}
+
+static void sampleHud(IdeWindow *window, void *arg) {
+  PerfHud * const hud = arg;
+  RenderFrameStats stats;
+  ideRenderStats(window, &stats);
+  if (stats.frames != hud->last_frame) {
+    XGLGpuStats gpu;
+    xglGpuTimerStats(&gpu);
+    hud->cpu_ms[hud->head] = (GLfloat) stats.cpu_ms;
+    hud->gpu_ms[hud->head] = (GLfloat) gpu.last;
+    hud->head = (hud->head + 1) % HUD_SAMPLES;
+    if (hud->n_samples < HUD_SAMPLES) { hud->n_samples++; }
+    hud->last_frame = stats.frames;
+    writeGraph(window, hud);
+  }
+  const double now = glfwGetTime();
+  if (now - hud->title_time >= TITLE_INTERVAL) { updateTitle(window, hud, &stats, now); }
+}
+
+void ideCreateHud(IdeWindow *window, const char *title, const GLuint rect_program,
+                  const GLuint program) {
+  const Allocator * const allocator = window->allocator;
+  PerfHud *hud = allocator->calloc(1, sizeof(PerfHud));
+  hud->title = title;
+
+  Array *rect_array = Array_new(sizeof(XGLRect), allocator);
+  XGLRect panel = {
+    .rect = {HUD_X, HUD_Y, GRAPH_WIDTH + 2 * GRAPH_INSET, GRAPH_HEIGHT + 2 * GRAPH_INSET},
+    .radii = {6, 6, 6, 6},
+    .border_width = 1.0f,
+  };
+  rgba2XGLColor8(0x101214D0, &panel.fill);
+  rgba2XGLColor8(0xFFFFFF40, &panel.border);
+  Array_append(rect_array, &panel, 1);
+  DrawTask *task = xglCreateRects(rect_array, HUD_PLANE, allocator);
+  releaseArray(rect_array);
+  if (!task) {
+    allocator->free(hud);
+    return;
+  }
+  xglBindShaderProgram(task, rect_program);
+  task->flags |= TF_HIDDEN | TF_SCREEN;
+  hud->panel = Array_length(window->drawTaskList);
+  ideWindowAddTasks(window, task, 1);
+  allocator->free(task);
+
+  task = xglCreateDynamicTask(TT_SOLID_AREA, 4 * GRAPH_QUADS, 6 * GRAPH_QUADS, HUD_PLANE + 1,
+                              allocator);
+  if (!task) {
+    allocator->free(hud);
+    return;
+  }
+  xglBindShaderProgram(task, program);
+  task->flags |= TF_HIDDEN | TF_SCREEN;
+  hud->graph = Array_length(window->drawTaskList);
+  ideWindowAddTasks(window, task, 1);
+  allocator->free(task);
+
+  window->hud = hud;
+}
+
+void ideDestroyHud(IdeWindow *window) {
+  if (!window->hud) { return; }
+  window->allocator->free(window->hud);
+  window->hud = nullptr;
+}
+
+void ideToggleHud(IdeWindow *window) {
+  PerfHud * const hud = window->hud;
+  if (!hud) { return; }
+  const bool visible = hud->timer == 0;
+  ideWindowShowTask(window, hud->panel, visible);
+  ideWindowShowTask(window, hud->graph, visible);
+  if (!visible) {
+    ideRemoveTimer(window, hud->timer);
+    hud->timer = 0;
+    glfwSetWindowTitle(window->info.handle, hud->title);
+    return;
+  }
+  RenderFrameStats stats;
+  ideRenderStats(window, &stats);
+  hud->last_frame = stats.frames;
+  hud->title_frame = stats.frames;
+  hud->title_time = glfwGetTime();
+  CountingAllocator_stats(&hud->title_allocs);
+  writeGraph(window, hud);
+  hud->timer = ideAddTimer(window, 0, 1.0 / 60, sampleHud, hud);
+}
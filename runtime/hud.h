@@ -0,0 +1,47 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: hud.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_HUD_H
+#define XIDE_HUD_H
+
+#include "allocator.h"
+#include "glad/glad.h"
+#include "widgets.h"
+#include <stdbool.h>
+
+// Performance overlay of a window, toggled by F3: a panel of rects and a graph of
+// CPU and GPU time of the last `HUD_SAMPLES` frames, which is a dynamic task, on the
+// top plane. There is no text rendering yet, so numbers go to the window title.
+// While shown, a timer samples render stats once per frame.
+
+#define HUD_SAMPLES 120
+
+typedef struct PerfHud {
+  const char *title;  // of window while HUD is hidden
+  uint32_t panel;     // index of panel task in window
+  uint32_t graph;     // index of graph task in window
+  uint32_t timer;     // 0 while hidden
+  GLfloat cpu_ms[HUD_SAMPLES];
+  GLfloat gpu_ms[HUD_SAMPLES];
+  uint32_t head;
+  uint32_t n_samples;
+  uint64_t last_frame;  // render stats frame sampled last
+  double title_time;
+  uint64_t title_frame;
+  AllocatorStats title_allocs;
+} PerfHud;
+
+// Create hidden HUD tasks of `window`, on the GL thread before the render thread
+// starts. `rect_program` draws the panel and `program` the graph, both in window pixels
+// whatever the scroll and zoom of the view.
+void ideCreateHud(IdeWindow *window, const char *title, GLuint rect_program, GLuint program);
+void ideDestroyHud(IdeWindow *window);
+void ideToggleHud(IdeWindow *window);
+
+#endif  // XIDE_HUD_H
@@ -1,10 +1,168 @@
-/**
- * Project Name: xide
- * Module Name: runtime
- * Filename: list.c
- * Creator: Yaokai Liu
- * Create Date: 2024-7-7
- * Copyright (c) 2024 Yaokai Liu. All rights reserved.
- **/
-
-#include "list.h"
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: list.c
+ * Creator: Yaokai Liu
+ * Create Date: 2024-7-7
+ * Copyright (c) 2024 Yaokai Liu. All rights reserved.
+ **/
+
+#include "list.h"
+#include <stdatomic.h>
+#include <string.h>
+
+void List_init(List *list) {
+  list->head.prev = &list->head;
+  list->head.next = &list->head;
+  list->length = 0;
+}
+
+inline uint32_t List_length(const List *list) {
+  return list->length;
+}
+
+inline bool List_empty(const List *list) {
+  return list->head.next == &list->head;
+}
+
+inline ListNode *List_first(const List *list) {
+  return List_empty(list) ? nullptr : list->head.next;
+}
+
+inline ListNode *List_last(const List *list) {
+  return List_empty(list) ? nullptr : list->head.prev;
+}
+
+inline void List_insert_after(List *list, ListNode *pos, ListNode *node) {
+  node->prev = pos;
+  node->next = pos->next;
+  pos->next->prev = node;
+  pos->next = node;
+  list->length++;
+}
+
+void List_push_front(List *list, ListNode *node) {
+  List_insert_after(list, &list->head, node);
+}
+
+void List_push_back(List *list, ListNode *node) {
+  List_insert_after(list, list->head.prev, node);
+}
+
+inline void List_unlink(List *list, ListNode *node) {
+  node->prev->next = node->next;
+  node->next->prev = node->prev;
+  node->prev = nullptr;
+  node->next = nullptr;
+  list->length--;
+}
+
+ListNode *List_pop_front(List *list) {
+  ListNode *node = List_first(list);
+  if (node) { List_unlink(list, node); }
+  return node;
+}
+
+ListNode *List_pop_back(List *list) {
+  ListNode *node = List_last(list);
+  if (node) { List_unlink(list, node); }
+  return node;
+}
+
+void List_move_to_front(List *list, ListNode *node) {
+  if (list->head.next == node) { return; }
+  List_unlink(list, node);
+  List_insert_after(list, &list->head, node);
+}
+
+// Bounded queue by Dmitry Vyukov: every cell carries a sequence number that
+// tells producers and the consumer whose turn the cell is. Producers race on
+// `enqueue_pos` with CAS; the only consumer owns `dequeue_pos`.
+#define CACHE_LINE 64
+
+struct Cell {
+  atomic_size_t sequence;
+  char data[];
+};
+
+struct MPSCQueue {
+  const Allocator *allocator;
+  uint32_t ele_size;
+  uint32_t cell_size;
+  size_t mask;
+  char *cells;
+  char pad0[CACHE_LINE];
+  atomic_size_t enqueue_pos;
+  char pad1[CACHE_LINE - sizeof(atomic_size_t)];
+  size_t dequeue_pos;
+};
+
+#define cell_at(_queue, _pos) \
+  ((struct Cell *) ((_queue)->cells + ((_pos) & (_queue)->mask) * (_queue)->cell_size))
+
+MPSCQueue *MPSCQueue_new(const uint32_t ele_size, const uint32_t capacity,
+                         const Allocator * const allocator) {
+  if (ele_size == 0 || capacity == 0) { return nullptr; }
+  size_t n_cells = 1;
+  while (n_cells < capacity) { n_cells <<= 1; }
+  const uint32_t align = sizeof(atomic_size_t);
+  const uint32_t cell_size = (sizeof(struct Cell) + ele_size + align - 1) / align * align;
+
+  MPSCQueue *queue = allocator->calloc(1, sizeof(MPSCQueue));
+  queue->cells = allocator->calloc(n_cells, cell_size);
+  if (!queue->cells) {
+    allocator->free(queue);
+    return nullptr;
+  }
+  queue->allocator = allocator;
+  queue->ele_size = ele_size;
+  queue->cell_size = cell_size;
+  queue->mask = n_cells - 1;
+  for (size_t i = 0; i < n_cells; i++) { atomic_init(&cell_at(queue, i)->sequence, i); }
+  atomic_init(&queue->enqueue_pos, 0);
+  queue->dequeue_pos = 0;
+  return queue;
+}
+
+inline uint32_t MPSCQueue_capacity(const MPSCQueue *queue) {
+  return (uint32_t) (queue->mask + 1);
+}
+
+bool MPSCQueue_push(MPSCQueue *queue, const void *element) {
+  struct Cell *cell;
+  size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+  for (;;) {
+    cell = cell_at(queue, pos);
+    const size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    const intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    }
+  }
+  memcpy(cell->data, element, queue->ele_size);
+  atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+  return true;
+}
+
+bool MPSCQueue_pop(MPSCQueue *queue, void *element) {
+  const size_t pos = queue->dequeue_pos;
+  struct Cell *cell = cell_at(queue, pos);
+  const size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+  if ((intptr_t) seq - (intptr_t) (pos + 1) < 0) { return false; }
+  memcpy(element, cell->data, queue->ele_size);
+  atomic_store_explicit(&cell->sequence, pos + queue->mask + 1, memory_order_release);
+  queue->dequeue_pos = pos + 1;
+  return true;
+}
+
+void MPSCQueue_destroy(MPSCQueue *queue) {
+  queue->allocator->free(queue->cells);
+  queue->allocator->free(queue);
+}
@@ -10,6 +10,65 @@
 #ifndef XIDE_LIST_H
 #define XIDE_LIST_H
 
-typedef struct List List;
+#include "allocator.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct ListNode {
+  struct ListNode *prev;
+  struct ListNode *next;
+} ListNode;
+
+// Intrusive doubly linked list: embed a `ListNode` in the element and get
+// the element back with `List_entry`. The list itself never allocates.
+typedef struct List {
+  ListNode head;
+  uint32_t length;
+} List;
+
+void List_init(List *list);
+uint32_t List_length(const List *list);
+bool List_empty(const List *list);
+// Return nullptr when list is empty.
+ListNode *List_first(const List *list);
+// Return nullptr when list is empty.
+ListNode *List_last(const List *list);
+void List_push_front(List *list, ListNode *node);
+void List_push_back(List *list, ListNode *node);
+// Suppose `pos` is in `list` and `node` is in no list.
+void List_insert_after(List *list, ListNode *pos, ListNode *node);
+// Suppose `node` is in `list`. O(1), and `node` is in no list after that.
+void List_unlink(List *list, ListNode *node);
+// Return nullptr when list is empty.
+ListNode *List_pop_front(List *list);
+// Return nullptr when list is empty.
+ListNode *List_pop_back(List *list);
+// Suppose `node` is in `list`. Make it the first one, e.g. an LRU touch.
+void List_move_to_front(List *list, ListNode *node);
+
+#define List_entry(_node, _type, _member) ((_type *) ((char *) (_node) - offsetof(_type, _member)))
+
+#define List_foreach(_node, _list) \
+  for (ListNode *_node = (_list)->head.next; _node != &(_list)->head; _node = _node->next)
+// Allow `List_unlink(list, _node)` in the loop body.
+#define List_foreach_safe(_node, _list)                                                      \
+  for (ListNode *_node = (_list)->head.next, *_node##_next = _node->next; _node != &(_list)->head; \
+       _node = _node##_next, _node##_next = _node->next)
+
+// Bounded lock-free multi-producer/single-consumer queue of fixed-size elements.
+// `MPSCQueue_push` may be called from any thread; `MPSCQueue_pop` only from
+// the one consumer thread. Elements are copied in and out.
+typedef struct MPSCQueue MPSCQueue;
+
+// `capacity` will be rounded up to a power of 2.
+MPSCQueue *MPSCQueue_new(uint32_t ele_size, uint32_t capacity, const Allocator *allocator);
+uint32_t MPSCQueue_capacity(const MPSCQueue *queue);
+// Return false if queue is full, and element is not pushed.
+bool MPSCQueue_push(MPSCQueue *queue, const void *element);
+// Return false if queue is empty. Consumer thread only.
+bool MPSCQueue_pop(MPSCQueue *queue, void *element);
+// Suppose no thread is using queue any more.
+void MPSCQueue_destroy(MPSCQueue *queue);
 
 #endif  // XIDE_LIST_H
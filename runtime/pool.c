@@ -0,0 +1,121 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: pool.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "pool.h"
+#include "trace.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+struct WorkerPool {
+  const Allocator *allocator;
+  uint32_t n_workers;
+  pthread_t *workers;
+  pthread_mutex_t mutex;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  // Every `WorkerPool_run` starts a new generation.
+  uint64_t generation;
+  bool stopping;
+  void (*fn_job)(uint32_t, void *);
+  void *arg;
+  uint32_t n_jobs;
+  atomic_uint next_job;
+  // Workers yet to check in for the current generation.
+  uint32_t n_busy;
+};
+
+static void runJobs(WorkerPool * const pool) {
+  for (;;) {
+    const uint32_t index = atomic_fetch_add_explicit(&pool->next_job, 1, memory_order_relaxed);
+    if (index >= pool->n_jobs) { break; }
+    pool->fn_job(index, pool->arg);
+  }
+}
+
+static void *workerMain(void *arg) {
+  TRACE_THREAD_NAME("worker");
+  WorkerPool * const pool = arg;
+  uint64_t seen = 0;
+  pthread_mutex_lock(&pool->mutex);
+  for (;;) {
+    while (!pool->stopping && pool->generation == seen) {
+      pthread_cond_wait(&pool->wake, &pool->mutex);
+    }
+    if (pool->stopping) { break; }
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->mutex);
+    runJobs(pool);
+    pthread_mutex_lock(&pool->mutex);
+    if (--pool->n_busy == 0) { pthread_cond_signal(&pool->done); }
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return nullptr;
+}
+
+WorkerPool *WorkerPool_new(uint32_t n_workers, const Allocator * const allocator) {
+  if (n_workers == 0) {
+    const long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    n_workers = n_cpus > 1 ? (uint32_t) n_cpus - 1 : 1;
+  }
+  WorkerPool *pool = allocator->calloc(1, sizeof(WorkerPool));
+  pool->allocator = allocator;
+  pool->workers = allocator->calloc(n_workers, sizeof(pthread_t));
+  pthread_mutex_init(&pool->mutex, nullptr);
+  pthread_cond_init(&pool->wake, nullptr);
+  pthread_cond_init(&pool->done, nullptr);
+  for (uint32_t i = 0; i < n_workers; i++) {
+    if (pthread_create(&pool->workers[i], nullptr, workerMain, pool) != 0) { break; }
+    pool->n_workers++;
+  }
+  return pool;
+}
+
+inline uint32_t WorkerPool_size(const WorkerPool *pool) {
+  return pool ? pool->n_workers : 0;
+}
+
+void WorkerPool_run(WorkerPool *pool, const uint32_t n_jobs, void (*fn_job)(uint32_t, void *),
+                    void *arg) {
+  if (!pool || pool->n_workers == 0 || n_jobs < 2) {
+    for (uint32_t i = 0; i < n_jobs; i++) { fn_job(i, arg); }
+    return;
+  }
+  pthread_mutex_lock(&pool->mutex);
+  pool->fn_job = fn_job;
+  pool->arg = arg;
+  pool->n_jobs = n_jobs;
+  atomic_store_explicit(&pool->next_job, 0, memory_order_relaxed);
+  pool->n_busy = pool->n_workers;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->mutex);
+
+  runJobs(pool);
+
+  // Jobs are all claimed now. Wait every worker to check in for this generation,
+  // so none of them is still running a job or could touch the job state later.
+  pthread_mutex_lock(&pool->mutex);
+  while (pool->n_busy != 0) { pthread_cond_wait(&pool->done, &pool->mutex); }
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+void WorkerPool_destroy(WorkerPool *pool) {
+  pthread_mutex_lock(&pool->mutex);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->mutex);
+  for (uint32_t i = 0; i < pool->n_workers; i++) { pthread_join(pool->workers[i], nullptr); }
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->wake);
+  pthread_mutex_destroy(&pool->mutex);
+  pool->allocator->free(pool->workers);
+  pool->allocator->free(pool);
+}
@@ -0,0 +1,31 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: pool.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_POOL_H
+#define XIDE_POOL_H
+
+#include "allocator.h"
+#include <stdint.h>
+
+// Fork-join pool of worker threads. The thread calling `WorkerPool_run`
+// takes jobs as well, so a pool of `n` workers runs `n + 1` jobs at once.
+typedef struct WorkerPool WorkerPool;
+
+// `n_workers` of 0 means one less than the number of online processors.
+WorkerPool *WorkerPool_new(uint32_t n_workers, const Allocator *allocator);
+// Return 0 for a nullptr pool.
+uint32_t WorkerPool_size(const WorkerPool *pool);
+// Run `fn_job(index, arg)` for every index in [0, n_jobs), and return when all are done.
+// Jobs run inline on the calling thread if `pool` is nullptr.
+// Not reentrant: a job must not call `WorkerPool_run` on the same pool.
+void WorkerPool_run(WorkerPool *pool, uint32_t n_jobs, void (*fn_job)(uint32_t, void *), void *arg);
+// Wait all workers to exit, and free pool.
+void WorkerPool_destroy(WorkerPool *pool);
+
+#endif  // XIDE_POOL_H
@@ -0,0 +1,104 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: program.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "program.h"
+#include "GLFW/glfw3.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+typedef void (APIENTRYP MaxShaderCompilerThreadsFn)(GLuint count);
+
+typedef struct PendingProgram {
+  GLuint program;
+  XGLProgramReadyFn fn;
+  void *arg;
+} PendingProgram;
+
+static struct {
+  bool parallel;
+  pthread_mutex_t lock;  // guards fields below
+  PendingProgram pending[XGL_PENDING_PROGRAMS];
+  uint32_t n_pending;
+  _Atomic uint32_t count;  // same as `n_pending`, read without the lock
+} PROGRAMS = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+static bool hasExtension(const char * const name) {
+  GLint n_extensions = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &n_extensions);
+  for (GLint i = 0; i < n_extensions; i++) {
+    const char * const extension = (const char *) glGetStringi(GL_EXTENSIONS, (GLuint) i);
+    if (extension && strcmp(extension, name) == 0) { return true; }
+  }
+  return false;
+}
+
+void xglInitPrograms(void) {
+  MaxShaderCompilerThreadsFn max_threads = nullptr;
+  if (hasExtension("GL_KHR_parallel_shader_compile")) {
+    max_threads = (MaxShaderCompilerThreadsFn) glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+  } else if (hasExtension("GL_ARB_parallel_shader_compile")) {
+    max_threads = (MaxShaderCompilerThreadsFn) glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+  }
+  // Both extensions take 0xFFFFFFFF as "up to the implementation".
+  if (max_threads) { max_threads(0xFFFFFFFF); }
+  PROGRAMS.parallel = max_threads != nullptr;
+}
+
+bool xglParallelCompile(void) {
+  return PROGRAMS.parallel;
+}
+
+void xglAwaitProgram(const GLuint program, const XGLProgramReadyFn fn, void *arg) {
+  pthread_mutex_lock(&PROGRAMS.lock);
+  const bool wait = PROGRAMS.parallel && PROGRAMS.n_pending < XGL_PENDING_PROGRAMS;
+  if (wait) {
+    PROGRAMS.pending[PROGRAMS.n_pending++] = (PendingProgram) {program, fn, arg};
+    atomic_store(&PROGRAMS.count, PROGRAMS.n_pending);
+  }
+  pthread_mutex_unlock(&PROGRAMS.lock);
+  if (!wait) { fn(program, arg); }
+}
+
+bool xglProgramPending(const GLuint program) {
+  if (atomic_load(&PROGRAMS.count) == 0) { return false; }
+  bool pending = false;
+  pthread_mutex_lock(&PROGRAMS.lock);
+  for (uint32_t i = 0; i < PROGRAMS.n_pending && !pending; i++) {
+    pending = PROGRAMS.pending[i].program == program;
+  }
+  pthread_mutex_unlock(&PROGRAMS.lock);
+  return pending;
+}
+
+uint32_t xglProgramsPending(void) {
+  return atomic_load(&PROGRAMS.count);
+}
+
+uint32_t xglPollPrograms(void) {
+  if (atomic_load(&PROGRAMS.count) == 0) { return 0; }
+  PendingProgram ready[XGL_PENDING_PROGRAMS];
+  uint32_t n_ready = 0;
+  pthread_mutex_lock(&PROGRAMS.lock);
+  for (uint32_t i = 0; i < PROGRAMS.n_pending;) {
+    GLint completed = GL_FALSE;
+    glGetProgramiv(PROGRAMS.pending[i].program, GL_COMPLETION_STATUS_KHR, &completed);
+    if (!completed) {
+      i++;
+      continue;
+    }
+    ready[n_ready++] = PROGRAMS.pending[i];
+    PROGRAMS.pending[i] = PROGRAMS.pending[--PROGRAMS.n_pending];
+  }
+  atomic_store(&PROGRAMS.count, PROGRAMS.n_pending);
+  pthread_mutex_unlock(&PROGRAMS.lock);
+  // Called without the lock, so that callbacks may query or wait on other programs.
+  for (uint32_t i = 0; i < n_ready; i++) { ready[i].fn(ready[i].program, ready[i].arg); }
+  return n_ready;
+}
@@ -0,0 +1,47 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: program.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_PROGRAM_H
+#define XIDE_PROGRAM_H
+
+#include "glad/glad.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Programs whose compile and link run on driver threads by `KHR_parallel_shader_compile`
+// (or its ARB twin). Until such a program completes, tasks drawn with it are skipped,
+// so frames are shown while shaders are still building.
+// Waiting and polling belong to the GL thread; `xglProgramPending` may be called anywhere.
+
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// Programs waited on at a time; more are waited on by blocking right away.
+#define XGL_PENDING_PROGRAMS 64
+
+typedef void (*XGLProgramReadyFn)(GLuint program, void *arg);
+
+// Detect parallel compile in the current GL context and let the driver use as many
+// compiler threads as it likes.
+void xglInitPrograms(void);
+bool xglParallelCompile(void);
+
+// Call `fn` on the GL thread once compile and link of `program` have completed, whether
+// succeeded or not. Without parallel compile `fn` is called now, which blocks on the link.
+void xglAwaitProgram(GLuint program, XGLProgramReadyFn fn, void *arg);
+bool xglProgramPending(GLuint program);
+uint32_t xglProgramsPending(void);
+// Call back programs which have completed. Returns how many did.
+uint32_t xglPollPrograms(void);
+
+#endif  // XIDE_PROGRAM_H
@@ -0,0 +1,369 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: render.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "render.h"
+#include "GLFW/glfw3.h"
+#include "batch.h"
+#include "gpu-timer.h"
+#include "list.h"
+#include "program.h"
+#include "ring.h"
+#include "runtime.h"
+#include "state.h"
+#include "trace.h"
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+#define RENDER_JOBS 256
+#define RENDER_FRAME_HOOKS 8
+// How often render thread wakes to poll programs still compiling and frames in flight.
+#define POLL_NS 4000000
+
+typedef struct RenderJob {
+  RenderJobFn fn;
+  void *arg;
+} RenderJob;
+
+struct RenderThread {
+  IdeWindow *window;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  FrameSnapshot pending;  // published by UI thread, guarded by `lock`
+  FrameSnapshot current;  // drawn by render thread
+  bool fresh;
+  bool present;  // show back buffer again without redrawing, guarded by `lock`
+  bool quit;
+  MPSCQueue *jobs;  // of RenderJob
+  RenderJob hooks[RENDER_FRAME_HOOKS];  // guarded by `lock`
+  uint32_t n_hooks;
+  _Atomic uint64_t n_submitted;
+  uint64_t n_executed;  // guarded by `lock`
+  RenderFrameStats stats;  // guarded by `lock`
+  _Atomic bool redraw;  // programs became ready, so UI thread should publish all again
+};
+
+static void initSnapshot(FrameSnapshot * const snapshot, const Allocator * const allocator) {
+  snapshot->tasks = Array_new(sizeof(DrawTask), allocator);
+  xglDamageRegionClear(&snapshot->damage);
+}
+
+static void copySnapshot(FrameSnapshot * const dest, const FrameSnapshot * const src) {
+  Array_clear(dest->tasks, nullptr);
+  const uint32_t n_tasks = Array_length(src->tasks);
+  if (n_tasks) { Array_append(dest->tasks, Array_get(src->tasks, 0), n_tasks); }
+  dest->version = src->version;
+  dest->frame = src->frame;
+  dest->view = src->view;
+  dest->damage = src->damage;
+}
+
+// Scissor box of `rect` in window pixels, clamped to back buffer.
+static void scissorRect(const BackBuffer *buffer, const GLfloat rect[4]) {
+  const GLint x0 = (GLint) fmaxf(floorf(rect[0]), 0);
+  const GLint y0 = (GLint) fmaxf(floorf(rect[1]), 0);
+  const GLint x1 = (GLint) fminf(ceilf(rect[2]), (GLfloat) buffer->width);
+  const GLint y1 = (GLint) fminf(ceilf(rect[3]), (GLfloat) buffer->height);
+  xglScissor(x0, buffer->height - y1, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+}
+
+// Bytes of dynamic tasks committed for `frame`, which GPU reads from mapped memory.
+static uint64_t streamedBytes(const FrameSnapshot * const frame) {
+  uint64_t bytes = 0;
+  const uint32_t n_tasks = Array_length(frame->tasks);
+  const DrawTask * const tasks = Array_get(frame->tasks, 0);
+  for (uint32_t i = 0; i < n_tasks; i++) {
+    if (!(tasks[i].flags & TF_DYNAMIC) || tasks[i].commit_frames[1] != frame->frame) { continue; }
+    bytes += (uint64_t) tasks[i].vertex_block.count * sizeof(XGLVertex)
+             + (uint64_t) tasks[i].n_index * sizeof(GLuint);
+  }
+  return bytes;
+}
+
+// Redraw damaged rects of `frame` into back buffer of window, then present it.
+static void renderFrame(RenderThread * const render, const FrameSnapshot * const frame) {
+  TRACE_ZONE("renderFrame");
+  const double start = glfwGetTime();
+  IdeWindow * const window = render->window;
+  BackBuffer * const buffer = window->backBuffer;
+  const GLsizei width = (GLsizei) frame->view.windowSize[0];
+  const GLsizei height = (GLsizei) frame->view.windowSize[1];
+  if (buffer->width != width || buffer->height != height) {
+    glViewport(0, 0, width, height);
+    xglResizeBackBuffer(buffer, width, height);
+  }
+
+  xglStateBeginFrame();
+  xglGpuFrameBegin();
+  xglCountUpload(streamedBytes(frame));
+  xglUploadViewState(&frame->view);
+  const uint32_t n_tasks = Array_length(frame->tasks);
+  const DrawTask *tasks = Array_get(frame->tasks, 0);
+  xglCompileDrawPasses(window->drawPasses, tasks, n_tasks, frame->version);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, buffer->framebuffer);
+  glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+  const DamageRegion * const damage = &frame->damage;
+  const uint32_t n_rects = damage->full ? 1 : damage->n_rects;
+  xglSetScissor(!damage->full);
+  for (uint32_t i = 0; i < n_rects; i++) {
+    if (!damage->full) { scissorRect(buffer, damage->rects[i]); }
+    xglGpuMark(GC_OTHER);
+    xglDepthMask(true);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    xglDrawPasses(window->drawPasses);
+  }
+  xglSetScissor(false);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  xglGpuMark(GC_OTHER);
+  xglPresentBackBuffer(buffer);
+  xglGpuFrameEnd();
+
+  pthread_mutex_lock(&render->lock);
+  render->stats.frames++;
+  render->stats.cpu_ms = (glfwGetTime() - start) * 1e3;
+  xglStateStats(&render->stats.state, nullptr);
+  pthread_mutex_unlock(&render->lock);
+
+  TRACE_BEGIN("swapBuffers");
+  glfwSwapBuffers(window->info.handle);
+  TRACE_END();
+  TRACE_BEGIN("fenceFrame");
+  xglRingEndFrame(xglGetStreamRing(), frame->frame);
+  TRACE_END();
+}
+
+// Show back buffer again, whose content outlives that of the window.
+static void presentFrame(RenderThread * const render) {
+  TRACE_ZONE("presentFrame");
+  IdeWindow * const window = render->window;
+  xglPresentBackBuffer(window->backBuffer);
+  glfwSwapBuffers(window->info.handle);
+}
+
+static void runJobs(RenderThread * const render) {
+  RenderJob job;
+  uint64_t n_jobs = 0;
+  while (MPSCQueue_pop(render->jobs, &job)) {
+    TRACE_ZONE("renderJob");
+    job.fn(job.arg);
+    n_jobs++;
+  }
+  if (n_jobs == 0) { return; }
+  pthread_mutex_lock(&render->lock);
+  render->n_executed += n_jobs;
+  pthread_cond_broadcast(&render->done);
+  pthread_mutex_unlock(&render->lock);
+}
+
+static void runFrameHooks(RenderThread * const render) {
+  RenderJob hooks[RENDER_FRAME_HOOKS];
+  pthread_mutex_lock(&render->lock);
+  const uint32_t n_hooks = render->n_hooks;
+  for (uint32_t i = 0; i < n_hooks; i++) { hooks[i] = render->hooks[i]; }
+  pthread_mutex_unlock(&render->lock);
+  for (uint32_t i = 0; i < n_hooks; i++) { hooks[i].fn(hooks[i].arg); }
+}
+
+// Whether programs are compiling or frames are in flight, which are polled for.
+static bool pollPending(void) {
+  return xglProgramsPending() || xglGetStreamRing()->n_fences;
+}
+
+// Sleep until woken, or until next poll if anything is polled for.
+static void waitWake(RenderThread * const render) {
+  if (!pollPending()) {
+    pthread_cond_wait(&render->wake, &render->lock);
+    return;
+  }
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_nsec += POLL_NS;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+  pthread_cond_timedwait(&render->wake, &render->lock, &deadline);
+}
+
+// Tasks of ready programs join the passes from next frame on. The snapshot drawn last
+// may have its dynamic tasks overwritten in the ring already, so it is not redrawn here;
+// UI thread publishes a fully damaged one instead.
+static void pollPrograms(RenderThread * const render) {
+  if (!xglPollPrograms()) { return; }
+  xglInvalidateDrawPasses(render->window->drawPasses);
+  atomic_store(&render->redraw, true);
+  glfwPostEmptyEvent();
+}
+
+static void *renderMain(void *arg) {
+  RenderThread * const render = arg;
+  IdeWindow * const window = render->window;
+  TRACE_THREAD_NAME("render");
+  glfwMakeContextCurrent(window->info.handle);
+  xglInitGpuTimer();
+  for (;;) {
+    pthread_mutex_lock(&render->lock);
+    while (!render->fresh && !render->present && !render->quit
+           && render->n_executed >= atomic_load(&render->n_submitted)) {
+      const bool pending = pollPending();
+      waitWake(render);
+      if (pending) { break; }
+    }
+    const bool quit = render->quit, fresh = render->fresh, present = render->present;
+    if (fresh) {
+      copySnapshot(&render->current, &render->pending);
+      render->fresh = false;
+    }
+    render->present = false;
+    pthread_mutex_unlock(&render->lock);
+
+    runJobs(render);
+    if (quit) { break; }
+    pollPrograms(render);
+    // Completed frames free ring regions, which UI thread maps again on its next tick.
+    xglRingPollFrames(xglGetStreamRing());
+    if (fresh) {
+      renderFrame(render, &render->current);
+      runFrameHooks(render);
+    } else if (present) {
+      presentFrame(render);
+    }
+  }
+  xglReleaseGpuTimer();
+  glfwMakeContextCurrent(nullptr);
+  return nullptr;
+}
+
+void ideStartRenderThread(IdeWindow *window) {
+  const Allocator * const allocator = window->allocator;
+  RenderThread *render = allocator->calloc(1, sizeof(RenderThread));
+  render->window = window;
+  pthread_mutex_init(&render->lock, nullptr);
+  pthread_cond_init(&render->wake, nullptr);
+  pthread_cond_init(&render->done, nullptr);
+  initSnapshot(&render->pending, allocator);
+  initSnapshot(&render->current, allocator);
+  render->jobs = MPSCQueue_new(sizeof(RenderJob), RENDER_JOBS, allocator);
+  window->renderThread = render;
+
+  glfwMakeContextCurrent(nullptr);
+  pthread_create(&render->thread, nullptr, renderMain, render);
+}
+
+void ideStopRenderThread(IdeWindow *window) {
+  RenderThread * const render = window->renderThread;
+  if (!render) { return; }
+  pthread_mutex_lock(&render->lock);
+  render->quit = true;
+  pthread_cond_signal(&render->wake);
+  pthread_mutex_unlock(&render->lock);
+  pthread_join(render->thread, nullptr);
+  glfwMakeContextCurrent(window->info.handle);
+
+  releaseArray(render->pending.tasks);
+  releaseArray(render->current.tasks);
+  MPSCQueue_destroy(render->jobs);
+  pthread_mutex_destroy(&render->lock);
+  pthread_cond_destroy(&render->wake);
+  pthread_cond_destroy(&render->done);
+  window->allocator->free(render);
+  window->renderThread = nullptr;
+}
+
+bool idePublishFrame(IdeWindow *window) {
+  TRACE_ZONE("publishFrame");
+  RenderThread * const render = window->renderThread;
+  if (atomic_exchange(&render->redraw, false)) { xglDamageAll(); }
+  DamageRegion * const damage = xglGetDamage();
+  if (xglDamageRegionEmpty(damage)) {
+    window->loopStats.idleFrames++;
+    return false;
+  }
+  FrameSnapshot * const pending = &render->pending;
+  pthread_mutex_lock(&render->lock);
+  if (!render->fresh) { xglDamageRegionClear(&pending->damage); }
+  xglDamageRegionMerge(&pending->damage, damage);
+  Array_clear(pending->tasks, nullptr);
+  const uint32_t n_tasks = Array_length(window->drawTaskList);
+  if (n_tasks) { Array_append(pending->tasks, Array_get(window->drawTaskList, 0), n_tasks); }
+  pending->version = window->drawTaskVersion;
+  pending->view = *xglGetViewState();
+  pending->view.time = (GLfloat) glfwGetTime();
+  pending->frame = xglRingPublish(xglGetStreamRing());
+  render->fresh = true;
+  pthread_cond_signal(&render->wake);
+  pthread_mutex_unlock(&render->lock);
+
+  xglDamageRegionClear(damage);
+  window->loopStats.frames++;
+  return true;
+}
+
+void idePresentFrame(IdeWindow *window) {
+  RenderThread * const render = window->renderThread;
+  pthread_mutex_lock(&render->lock);
+  render->present = true;
+  pthread_cond_signal(&render->wake);
+  pthread_mutex_unlock(&render->lock);
+}
+
+void ideRenderCall(IdeWindow *window, const RenderJobFn fn, void *arg) {
+  RenderThread * const render = window->renderThread;
+  const RenderJob job = {fn, arg};
+  while (!MPSCQueue_push(render->jobs, &job)) { sched_yield(); }
+  atomic_fetch_add(&render->n_submitted, 1);
+  pthread_mutex_lock(&render->lock);
+  pthread_cond_signal(&render->wake);
+  pthread_mutex_unlock(&render->lock);
+}
+
+void ideAddFrameHook(IdeWindow *window, const RenderJobFn fn, void *arg) {
+  RenderThread * const render = window->renderThread;
+  pthread_mutex_lock(&render->lock);
+  if (render->n_hooks < RENDER_FRAME_HOOKS) {
+    render->hooks[render->n_hooks++] = (RenderJob) {fn, arg};
+  } else {
+    rt_warning("%s", "Too many frame hooks, hook is not added");
+  }
+  pthread_mutex_unlock(&render->lock);
+}
+
+void ideRemoveFrameHook(IdeWindow *window, const RenderJobFn fn, void *arg) {
+  RenderThread * const render = window->renderThread;
+  pthread_mutex_lock(&render->lock);
+  for (uint32_t i = 0; i < render->n_hooks; i++) {
+    if (render->hooks[i].fn != fn || render->hooks[i].arg != arg) { continue; }
+    render->n_hooks--;
+    for (uint32_t j = i; j < render->n_hooks; j++) { render->hooks[j] = render->hooks[j + 1]; }
+    break;
+  }
+  pthread_mutex_unlock(&render->lock);
+}
+
+void ideRenderStats(IdeWindow *window, RenderFrameStats *stats) {
+  RenderThread * const render = window->renderThread;
+  pthread_mutex_lock(&render->lock);
+  *stats = render->stats;
+  pthread_mutex_unlock(&render->lock);
+}
+
+void ideRenderSync(IdeWindow *window) {
+  RenderThread * const render = window->renderThread;
+  const uint64_t target = atomic_load(&render->n_submitted);
+  pthread_mutex_lock(&render->lock);
+  while (render->n_executed < target) { pthread_cond_wait(&render->done, &render->lock); }
+  pthread_mutex_unlock(&render->lock);
+}
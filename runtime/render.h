@@ -0,0 +1,62 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: render.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_RENDER_H
+#define XIDE_RENDER_H
+
+#include "damage.h"
+#include "draw.h"
+#include "state.h"
+#include "view.h"
+#include "widgets.h"
+
+// Everything the render thread needs to draw one frame, copied from the UI thread.
+typedef struct FrameSnapshot {
+  Array *tasks;  // Array<DrawTask>
+  uint64_t version;  // of window's task list
+  uint64_t frame;  // number given by `xglRingPublish`
+  XGLViewState view;
+  DamageRegion damage;
+} FrameSnapshot;
+
+// Measured by the render thread on the last frame it drew.
+typedef struct RenderFrameStats {
+  uint64_t frames;  // drawn since render thread started
+  double cpu_ms;    // from taking the snapshot until swap is issued
+  XGLStateStats state;
+} RenderFrameStats;
+
+// GL thread of a window, see render.c.
+typedef struct RenderThread RenderThread;
+typedef void (*RenderJobFn)(void *arg);
+
+// Move GL context of `window` from calling thread to a new render thread. The UI
+// thread then only publishes snapshots, and runs GL work through `ideRenderCall`.
+void ideStartRenderThread(IdeWindow *window);
+// Run jobs already submitted, join render thread, and make GL context current on
+// calling thread again.
+void ideStopRenderThread(IdeWindow *window);
+// Publish a snapshot of task list, view state and damage of `window`, if anything is
+// damaged. When the render thread is late, unconsumed damage is merged into the
+// new snapshot and the older one is never drawn. Return true if published.
+bool idePublishFrame(IdeWindow *window);
+// Show back buffer of `window` again without redrawing it, unless a frame published
+// meanwhile shows it anyway.
+void idePresentFrame(IdeWindow *window);
+// Run `fn` on the render thread before it draws next frame, in order of calls.
+void ideRenderCall(IdeWindow *window, RenderJobFn fn, void *arg);
+// Block until every job submitted so far has run.
+void ideRenderSync(IdeWindow *window);
+// Call `fn` on the render thread after every frame it draws, once GPU has completed that
+// frame, e.g. to release GL objects frames in flight were using. Hooks run in order added.
+void ideAddFrameHook(IdeWindow *window, RenderJobFn fn, void *arg);
+void ideRemoveFrameHook(IdeWindow *window, RenderJobFn fn, void *arg);
+void ideRenderStats(IdeWindow *window, RenderFrameStats *stats);
+
+#endif  // XIDE_RENDER_H
@@ -0,0 +1,133 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: ring.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "ring.h"
+#include <stddef.h>
+
+#define RING_UNITS         (1 << 16)
+#define RING_WAIT_TIMEOUT  1000000  // in nanoseconds, per try
+
+static StreamRing *CURRENT_STREAM_RING = nullptr;
+
+StreamRing *xglCreateStreamRing(const uint32_t region_units, const Allocator * const allocator) {
+  StreamRing *ring = allocator->calloc(1, sizeof(StreamRing));
+  ring->allocator = allocator;
+  ring->region_units = region_units;
+  const GLsizeiptr size = (GLsizeiptr) region_units * XGL_RING_FRAMES * sizeof(XGLVertex);
+  const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glCreateBuffers(1, &ring->buffer);
+  glNamedBufferStorage(ring->buffer, size, nullptr, flags);
+  ring->mapped = glMapNamedBufferRange(ring->buffer, 0, size, flags);
+  ring->free_list = Array_new(sizeof(HeapBlock), allocator);
+  pthread_mutex_init(&ring->lock, nullptr);
+  const HeapBlock whole = {0, region_units};
+  Array_append(ring->free_list, &whole, 1);
+
+  glCreateVertexArrays(1, &ring->VAO);
+  glEnableVertexArrayAttrib(ring->VAO, LOC_VERTEX);
+  glEnableVertexArrayAttrib(ring->VAO, LOC_COLOR);
+  glVertexArrayAttribBinding(ring->VAO, LOC_VERTEX, 0);
+  glVertexArrayAttribFormat(ring->VAO, LOC_VERTEX, 2, GL_FLOAT, GL_FALSE,
+                            offsetof(XGLVertex, coord));
+  glVertexArrayAttribBinding(ring->VAO, LOC_COLOR, 0);
+  glVertexArrayAttribFormat(ring->VAO, LOC_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                            offsetof(XGLVertex, color));
+  glVertexArrayVertexBuffer(ring->VAO, 0, ring->buffer, 0, sizeof(XGLVertex));
+  glVertexArrayElementBuffer(ring->VAO, ring->buffer);
+  return ring;
+}
+
+void xglDestroyStreamRing(StreamRing *ring) {
+  for (uint32_t i = 0; i < ring->n_fences; i++) {
+    glDeleteSync(ring->fences[(ring->fence_head + i) % XGL_RING_FRAMES]);
+  }
+  pthread_mutex_destroy(&ring->lock);
+  glDeleteVertexArrays(1, &ring->VAO);
+  glUnmapNamedBuffer(ring->buffer);
+  glDeleteBuffers(1, &ring->buffer);
+  releaseArray(ring->free_list);
+  ring->allocator->free(ring);
+}
+
+inline bool xglRingAlloc(StreamRing * const ring, const uint32_t units, HeapBlock * const slot) {
+  return xglBlockAlloc(ring->free_list, units, slot);
+}
+
+inline void xglRingFree(StreamRing * const ring, const HeapBlock * const slot) {
+  xglBlockFree(ring->free_list, slot);
+}
+
+inline void *xglRingMap(const StreamRing * const ring, const uint32_t region,
+                        const uint32_t offset) {
+  const size_t unit = xglRingRegionBase(ring, region) + offset;
+  return ring->mapped + unit * sizeof(XGLVertex);
+}
+
+inline uint32_t xglRingRegionBase(const StreamRing * const ring, const uint32_t region) {
+  return region * ring->region_units;
+}
+
+inline uint64_t xglRingPublish(StreamRing * const ring) {
+  return ring->published++;
+}
+
+bool xglRingFramesCompleted(StreamRing * const ring, const uint64_t frame) {
+  pthread_mutex_lock(&ring->lock);
+  const bool completed = ring->completed >= frame;
+  pthread_mutex_unlock(&ring->lock);
+  return completed;
+}
+
+// Wait on oldest fence for `timeout` nanoseconds, and pop it if it has signaled.
+static bool waitOldest(StreamRing * const ring, const GLbitfield flags, const GLuint64 timeout) {
+  const GLsync fence = ring->fences[ring->fence_head];
+  const GLenum status = glClientWaitSync(fence, flags, timeout);
+  if (status == GL_TIMEOUT_EXPIRED) { return false; }
+  glDeleteSync(fence);
+  const uint64_t frame = ring->fence_frames[ring->fence_head];
+  ring->fence_head = (ring->fence_head + 1) % XGL_RING_FRAMES;
+  ring->n_fences--;
+  pthread_mutex_lock(&ring->lock);
+  // Frames skipped by the render thread are never drawn, so they complete too.
+  if (ring->completed < frame + 1) { ring->completed = frame + 1; }
+  pthread_mutex_unlock(&ring->lock);
+  return true;
+}
+
+bool xglRingPollFrames(StreamRing * const ring) {
+  while (ring->n_fences && waitOldest(ring, 0, 0)) {}
+  return ring->n_fences != 0;
+}
+
+void xglRingEndFrame(StreamRing * const ring, const uint64_t frame) {
+  xglRingPollFrames(ring);
+  if (ring->n_fences == XGL_RING_FRAMES) {
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (!waitOldest(ring, flags, RING_WAIT_TIMEOUT)) { flags = 0; }
+  }
+  const uint32_t tail = (ring->fence_head + ring->n_fences) % XGL_RING_FRAMES;
+  ring->fences[tail] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  ring->fence_frames[tail] = frame;
+  ring->n_fences++;
+}
+
+void xglInitStreamRing(const Allocator *allocator) {
+  if (CURRENT_STREAM_RING) { return; }
+  CURRENT_STREAM_RING = xglCreateStreamRing(RING_UNITS, allocator);
+}
+
+inline StreamRing *xglGetStreamRing(void) {
+  return CURRENT_STREAM_RING;
+}
+
+void xglReleaseStreamRing(void) {
+  if (!CURRENT_STREAM_RING) { return; }
+  xglDestroyStreamRing(CURRENT_STREAM_RING);
+  CURRENT_STREAM_RING = nullptr;
+}
@@ -0,0 +1,78 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: ring.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_RING_H
+#define XIDE_RING_H
+
+#include "array.h"
+#include "heap.h"
+#include "xgl-object.h"
+#include <pthread.h>
+
+#define XGL_RING_FRAMES 3
+
+// A persistently and coherently mapped buffer split into `XGL_RING_FRAMES` regions.
+// Space is handed out in slots of `XGLVertex`-sized units; a slot has the same
+// offset in every region. Indices are stored in the same slot, after vertices.
+// Each commit of a dynamic task moves it to the next region of its slot, so CPU
+// writes one region while frames in flight read the others.
+// Frames are numbered by the snapshots they draw: the UI thread numbers them at
+// publish, and the render thread fences each one it draws and marks it completed once
+// its fence signals. Up to `XGL_RING_FRAMES` frames are in flight.
+// Mapped memory may be written by any thread.
+typedef struct StreamRing {
+  iXGLVbo buffer;
+  uint8_t *mapped;
+  uint32_t region_units;  // size of one region, in units of XGLVertex
+  Array *free_list;  // Array<HeapBlock> of slots, in units
+  iXGLVao VAO;
+  uint64_t published;  // number of next frame to publish, UI thread only
+  uint64_t completed;  // every frame below it is completed by GPU
+  pthread_mutex_t lock;  // guards `completed` against readers off the GL thread
+  // Fences of frames in flight, oldest first from `fence_head`; GL thread only.
+  GLsync fences[XGL_RING_FRAMES];
+  uint64_t fence_frames[XGL_RING_FRAMES];
+  uint32_t fence_head;
+  uint32_t n_fences;
+  const Allocator *allocator;
+} StreamRing;
+
+// Number of units holding `n_indices` indices of GLuint.
+#define xglRingIndexUnits(_n_indices) \
+  (((_n_indices) * sizeof(GLuint) + sizeof(XGLVertex) - 1) / sizeof(XGLVertex))
+
+StreamRing *xglCreateStreamRing(uint32_t region_units, const Allocator *allocator);
+void xglDestroyStreamRing(StreamRing *ring);
+
+// Reserve a slot of `units` in every region. Return false if ring is full.
+bool xglRingAlloc(StreamRing *ring, uint32_t units, HeapBlock *slot);
+void xglRingFree(StreamRing *ring, const HeapBlock *slot);
+// Mapped address of `offset` units into `region`.
+void *xglRingMap(const StreamRing *ring, uint32_t region, uint32_t offset);
+// Offset of `region` in the whole buffer, in units.
+uint32_t xglRingRegionBase(const StreamRing *ring, uint32_t region);
+// Number the frame being published, UI thread only.
+uint64_t xglRingPublish(StreamRing *ring);
+// Whether every frame numbered below `frame` is completed. It never blocks, so the
+// UI thread does not wait on GPU or vsync.
+bool xglRingFramesCompleted(StreamRing *ring, uint64_t frame);
+// Mark frames whose fences have signaled as completed, without blocking. Return true
+// if frames are still in flight. GL thread only.
+bool xglRingPollFrames(StreamRing *ring);
+// Fence frame numbered `frame` after all its draws are issued. Blocks only while
+// `XGL_RING_FRAMES` frames are already in flight, until the oldest completes.
+// GL thread only.
+void xglRingEndFrame(StreamRing *ring, uint64_t frame);
+
+// Stream ring of the current GL context, used by dynamic draw tasks.
+void xglInitStreamRing(const Allocator *allocator);
+StreamRing *xglGetStreamRing(void);
+void xglReleaseStreamRing(void);
+
+#endif  // XIDE_RING_H
@@ -8,8 +8,21 @@
  **/
 
 #include "runtime.h"
+#include "list.h"
+#include "program.h"
+#include "state.h"
+#include <math.h>
+#include <sched.h>
 #include <stdio.h>
 
+#define MAX_DUE_TIMERS 8
+#define UI_CALLS 64
+
+typedef struct IdeCall {
+  IdeTimerFn fn;
+  void *arg;
+} IdeCall;
+
 GLFWmonitor *switchMonitor(int index, int *width, int *height) {
   int monitorCount;
   GLFWmonitor **monitors = glfwGetMonitors(&monitorCount);
@@ -28,15 +41,100 @@ GLFWmonitor *switchMonitor(int index, int *width, int *height) {
 
 void ideWindowAddTasks(IdeWindow *window, DrawTask *task, int count) {
   Array_append(window->drawTaskList, task, count);
+  for (int i = 0; i < count; i++) { xglDamageBounds(task[i].bounds, task[i].flags & TF_SCREEN); }
+  window->drawTaskVersion++;
 }
 
-void ideDrawUI(IdeWindow *window) {
-  glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT);
-  const int n_tasks = (int) Array_length(window->drawTaskList);
-  const DrawTask *tasks = Array_get(window->drawTaskList, 0);
-  for (int i = 0; i < n_tasks; i++) { xglDraw(&tasks[i], window); }
-  glfwSwapBuffers(window->info.handle);
+DrawTask *ideWindowGetTask(IdeWindow *window, uint32_t index) {
+  return Array_get(window->drawTaskList, index);
+}
+
+void ideWindowShowTask(IdeWindow *window, const uint32_t index, const bool visible) {
+  DrawTask * const task = Array_get(window->drawTaskList, index);
+  if (!(task->flags & TF_HIDDEN) == visible) { return; }
+  task->flags ^= TF_HIDDEN;
+  xglDamageBounds(task->bounds, task->flags & TF_SCREEN);
+  window->drawTaskVersion++;
+}
+
+void ideInvalidate(IdeWindow *window, const GLfloat rect[4]) {
+  if (rect) {
+    xglDamageRegionAdd(xglGetDamage(), rect);
+  } else {
+    xglDamageAll();
+  }
+  glfwPostEmptyEvent();
+}
+
+uint32_t ideAddTimer(IdeWindow *window, const double delay, const double interval,
+                     const IdeTimerFn fn, void *arg) {
+  const IdeTimer timer = {
+    .id = ++window->nextTimerId,
+    .deadline = glfwGetTime() + delay,
+    .interval = interval,
+    .fn = fn,
+    .arg = arg,
+  };
+  Array_append(window->timers, &timer, 1);
+  return timer.id;
+}
+
+void ideRemoveTimer(IdeWindow *window, const uint32_t id) {
+  const IdeTimer * const timers = Array_get(window->timers, 0);
+  for (uint32_t i = 0; i < Array_length(window->timers); i++) {
+    if (timers[i].id != id) { continue; }
+    Array_remove(window->timers, i, 1);
+    return;
+  }
+}
+
+// Reschedule or remove due timers first, then call them, so that they may add or
+// remove timers themselves. Timers beyond `MAX_DUE_TIMERS` run at next wake.
+static void runDueTimers(IdeWindow *window, const double now) {
+  IdeTimer due[MAX_DUE_TIMERS];
+  uint32_t n_due = 0;
+  for (uint32_t i = 0; i < Array_length(window->timers) && n_due < MAX_DUE_TIMERS;) {
+    IdeTimer * const timer = Array_get(window->timers, i);
+    if (timer->deadline > now) {
+      i++;
+      continue;
+    }
+    due[n_due++] = *timer;
+    if (timer->interval > 0) {
+      timer->deadline += timer->interval;
+      if (timer->deadline <= now) { timer->deadline = now + timer->interval; }
+      i++;
+    } else {
+      Array_remove(window->timers, i, 1);
+    }
+  }
+  for (uint32_t i = 0; i < n_due; i++) { due[i].fn(window, due[i].arg); }
+}
+
+void ideWaitEvents(IdeWindow *window) {
+  double next = INFINITY;
+  const IdeTimer * const timers = Array_get(window->timers, 0);
+  for (uint32_t i = 0; i < Array_length(window->timers); i++) {
+    next = fmin(next, timers[i].deadline);
+  }
+  const double now = glfwGetTime();
+  if (!xglDamageRegionEmpty(xglGetDamage()) || next <= now) {
+    glfwPollEvents();
+  } else if (next == INFINITY) {
+    glfwWaitEvents();
+  } else {
+    glfwWaitEventsTimeout(next - now);
+  }
+  window->loopStats.wakes++;
+  runDueTimers(window, glfwGetTime());
+  IdeCall call;
+  while (MPSCQueue_pop(window->uiCalls, &call)) { call.fn(window, call.arg); }
+}
+
+void ideUiCall(IdeWindow *window, const IdeTimerFn fn, void *arg) {
+  const IdeCall call = {fn, arg};
+  while (!MPSCQueue_push(window->uiCalls, &call)) { sched_yield(); }
+  glfwPostEmptyEvent();
 }
 
 IdeWindow *ideCreateWindow(GLFWwindow *handle, const Allocator *allocator) {
@@ -61,17 +159,36 @@ IdeWindow *ideCreateWindow(GLFWwindow *handle, const Allocator *allocator) {
   window->viewport[2] = (float) viewport[2];
   window->viewport[3] = (float) viewport[3];
 
+  xglStateInvalidate();
+  xglInitPrograms();
+  xglInitViewState();
+  xglSetViewSize(window->viewport[2], window->viewport[3]);
+  xglInitGeometryHeap(allocator);
+  xglInitStreamRing(allocator);
   window->drawTaskList = Array_new(sizeof(DrawTask), allocator);
+  window->drawPasses = xglCreateDrawPasses(allocator);
+  window->backBuffer = xglCreateBackBuffer(viewport[2], viewport[3], allocator);
+  window->timers = Array_new(sizeof(IdeTimer), allocator);
+  window->uiCalls = MPSCQueue_new(sizeof(IdeCall), UI_CALLS, allocator);
   window->allocator = allocator;
   return window;
 }
 
 void ideDestroyWindow(IdeWindow *window) {
+  ideStopRenderThread(window);
+  ideDestroyHud(window);
   const int n_tasks = (int) Array_length(window->drawTaskList);
   DrawTask *tasks = Array_get(window->drawTaskList, 0);
   for (int i = 0; i < n_tasks; i++) { xglDestroyDrawTask(&tasks[i]); }
   Array_reset(window->drawTaskList, nullptr);
   Array_destroy(window->drawTaskList);
+  xglDestroyDrawPasses(window->drawPasses);
+  xglDestroyBackBuffer(window->backBuffer);
+  releaseArray(window->timers);
+  MPSCQueue_destroy(window->uiCalls);
+  xglReleaseGeometryHeap();
+  xglReleaseStreamRing();
+  xglReleaseViewState();
   glfwDestroyWindow(window->info.handle);
   window->allocator->free(window);
 }
@@ -10,9 +10,15 @@
 #ifndef XIDE_RUNTIME_H
 #define XIDE_RUNTIME_H
 
+#include "batch.h"
+#include "damage.h"
 #include "draw.h"
 #include "glad/glad.h"
 #include "glfw/glfw3.h"
+#include "gpu-timer.h"
+#include "hud.h"
+#include "render.h"
+#include "view.h"
 #include "widgets.h"
 #include "xgl-object.h"
 
@@ -28,11 +34,41 @@ GLFWmonitor *switchMonitor(int index, int *width, int *height);
 
 void ideSetWindowSize(GLFWwindow *handle, int width, int height);
 void ideWindowRefreshCallback(GLFWwindow *handle);
+// F3 toggles the performance HUD.
+void ideKeyCallback(GLFWwindow *handle, int key, int scancode, int action, int mods);
 void ideProcessInput(GLFWwindow *window);
 IdeWindow *ideCreateWindow(GLFWwindow *handle, const Allocator *allocator);
 void ideDestroyWindow(IdeWindow *window);
 
-void ideDrawUI(IdeWindow *window);
+// Damage `rect` (x0, y0, x1, y1 in window pixels), or whole window if `rect` is
+// nullptr, and wake a blocked `ideWaitEvents`.
+void ideInvalidate(IdeWindow *window, const GLfloat rect[4]);
+
+typedef void (*IdeTimerFn)(IdeWindow *window, void *arg);
+
+typedef struct IdeTimer {
+  uint32_t id;
+  double deadline;  // in seconds of `glfwGetTime`
+  double interval;  // 0 if timer fires only once
+  IdeTimerFn fn;
+  void *arg;
+} IdeTimer;
+
+// Call `fn` after `delay` seconds, and then every `interval` seconds if it is not 0.
+// Animations are timers with interval of one frame. Return id of timer.
+uint32_t ideAddTimer(IdeWindow *window, double delay, double interval, IdeTimerFn fn, void *arg);
+void ideRemoveTimer(IdeWindow *window, uint32_t id);
+// Block until input, invalidation or next timer, then run due timers and UI calls.
+// It does not block while damage is pending.
+void ideWaitEvents(IdeWindow *window);
+// Run `fn` on the UI thread at its next wake, in order of calls. It may be called from
+// any thread, e.g. to hand results of render thread jobs back to the task list.
+void ideUiCall(IdeWindow *window, IdeTimerFn fn, void *arg);
 void ideWindowAddTasks(IdeWindow *window, DrawTask *task, int count);
+// Task stored in window, valid until tasks are added. Dynamic tasks are updated
+// through it, without changing the task list version.
+DrawTask *ideWindowGetTask(IdeWindow *window, uint32_t index);
+// Hide task at `index` or show it again, keeping its place in the task list.
+void ideWindowShowTask(IdeWindow *window, uint32_t index, bool visible);
 
 #endif  // XIDE_RUNTIME_H
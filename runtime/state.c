@@ -0,0 +1,209 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: state.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "state.h"
+#include "view.h"
+#include <string.h>
+
+// Uniform values are cached by (program, location) in a small direct-mapped
+// table; a collision just evicts the older entry.
+#define UNIFORM_CACHE_SIZE 64
+
+struct UniformEntry {
+  GLuint program;
+  GLint location;
+  GLsizei n_values;
+  GLfloat values[4];
+};
+
+enum STATE_FLAG {
+  SF_PROGRAM = 1 << 0,
+  SF_VAO = 1 << 1,
+  SF_POLYGON_MODE = 1 << 2,
+  SF_BLEND = 1 << 3,
+  SF_BLEND_FUNC = 1 << 4,
+  SF_SCISSOR = 1 << 5,
+  SF_SCISSOR_BOX = 1 << 6,
+  SF_DEPTH_TEST = 1 << 7,
+  SF_DEPTH_MASK = 1 << 8,
+  SF_DEPTH_FUNC = 1 << 9,
+  SF_VIEW_BUFFER = 1 << 10,
+};
+
+static struct {
+  uint32_t known;  // enum STATE_FLAG
+  GLuint program;
+  GLuint vao;
+  GLenum polygon_mode;
+  bool blend;
+  GLenum blend_func[2];
+  bool depth_test;
+  bool depth_mask;
+  GLenum depth_func;
+  bool scissor;
+  GLint scissor_box[4];
+  GLuint view_buffer;
+  GLintptr view_offset;
+  struct UniformEntry uniforms[UNIFORM_CACHE_SIZE];
+  XGLStateStats current;
+  XGLStateStats last_frame;
+} STATE_CACHE = {};
+
+#define skip_if_known(_flag, _same)                                 \
+  do {                                                              \
+    if ((STATE_CACHE.known & (_flag)) && (_same)) {                 \
+      STATE_CACHE.current.skipped++;                                \
+      return;                                                       \
+    }                                                               \
+    STATE_CACHE.known |= (_flag);                                   \
+    STATE_CACHE.current.issued++;                                   \
+  } while (false)
+
+void xglStateInvalidate(void) {
+  STATE_CACHE.known = 0;
+  memset(STATE_CACHE.uniforms, 0, sizeof(STATE_CACHE.uniforms));
+}
+
+void xglStateBeginFrame(void) {
+  STATE_CACHE.last_frame = STATE_CACHE.current;
+  memset(&STATE_CACHE.current, 0, sizeof(XGLStateStats));
+}
+
+void xglStateStats(XGLStateStats *current, XGLStateStats *last_frame) {
+  if (current) { *current = STATE_CACHE.current; }
+  if (last_frame) { *last_frame = STATE_CACHE.last_frame; }
+}
+
+void xglCountDraw(const GLenum mode, const uint64_t count, const uint32_t n_instances) {
+  STATE_CACHE.current.draws++;
+  switch (mode) {
+    case GL_TRIANGLES: STATE_CACHE.current.triangles += count / 3 * n_instances; break;
+    case GL_TRIANGLE_STRIP:
+      if (count > 2) { STATE_CACHE.current.triangles += (count - 2) * n_instances; }
+      break;
+    default: {
+    }
+  }
+}
+
+void xglCountUpload(const uint64_t bytes) {
+  STATE_CACHE.current.uploaded += bytes;
+}
+
+void xglUseProgram(const GLuint program) {
+  skip_if_known(SF_PROGRAM, STATE_CACHE.program == program);
+  STATE_CACHE.program = program;
+  glUseProgram(program);
+}
+
+void xglBindVertexArray(const GLuint vao) {
+  skip_if_known(SF_VAO, STATE_CACHE.vao == vao);
+  STATE_CACHE.vao = vao;
+  glBindVertexArray(vao);
+}
+
+void xglPolygonMode(const GLenum mode) {
+  skip_if_known(SF_POLYGON_MODE, STATE_CACHE.polygon_mode == mode);
+  STATE_CACHE.polygon_mode = mode;
+  glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void xglSetBlend(const bool enabled) {
+  skip_if_known(SF_BLEND, STATE_CACHE.blend == enabled);
+  STATE_CACHE.blend = enabled;
+  if (enabled) {
+    glEnable(GL_BLEND);
+  } else {
+    glDisable(GL_BLEND);
+  }
+}
+
+void xglBlendFunc(const GLenum src_factor, const GLenum dst_factor) {
+  skip_if_known(SF_BLEND_FUNC, STATE_CACHE.blend_func[0] == src_factor
+                                 && STATE_CACHE.blend_func[1] == dst_factor);
+  STATE_CACHE.blend_func[0] = src_factor;
+  STATE_CACHE.blend_func[1] = dst_factor;
+  glBlendFunc(src_factor, dst_factor);
+}
+
+void xglSetDepthTest(const bool enabled) {
+  skip_if_known(SF_DEPTH_TEST, STATE_CACHE.depth_test == enabled);
+  STATE_CACHE.depth_test = enabled;
+  if (enabled) {
+    glEnable(GL_DEPTH_TEST);
+  } else {
+    glDisable(GL_DEPTH_TEST);
+  }
+}
+
+void xglDepthMask(const bool enabled) {
+  skip_if_known(SF_DEPTH_MASK, STATE_CACHE.depth_mask == enabled);
+  STATE_CACHE.depth_mask = enabled;
+  glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void xglDepthFunc(const GLenum func) {
+  skip_if_known(SF_DEPTH_FUNC, STATE_CACHE.depth_func == func);
+  STATE_CACHE.depth_func = func;
+  glDepthFunc(func);
+}
+
+void xglSetScissor(const bool enabled) {
+  skip_if_known(SF_SCISSOR, STATE_CACHE.scissor == enabled);
+  STATE_CACHE.scissor = enabled;
+  if (enabled) {
+    glEnable(GL_SCISSOR_TEST);
+  } else {
+    glDisable(GL_SCISSOR_TEST);
+  }
+}
+
+void xglScissor(const GLint x, const GLint y, const GLsizei width, const GLsizei height) {
+  const GLint box[4] = {x, y, width, height};
+  skip_if_known(SF_SCISSOR_BOX, memcmp(STATE_CACHE.scissor_box, box, sizeof(box)) == 0);
+  memcpy(STATE_CACHE.scissor_box, box, sizeof(box));
+  glScissor(x, y, width, height);
+}
+
+void xglBindViewBuffer(const GLuint buffer, const GLintptr offset) {
+  skip_if_known(SF_VIEW_BUFFER,
+                STATE_CACHE.view_buffer == buffer && STATE_CACHE.view_offset == offset);
+  STATE_CACHE.view_buffer = buffer;
+  STATE_CACHE.view_offset = offset;
+  glBindBufferRange(GL_UNIFORM_BUFFER, XGL_VIEW_STATE_BINDING, buffer, offset,
+                    sizeof(XGLViewState));
+}
+
+// Return true if uniform already has `values`; otherwise remember them.
+static bool uniformCached(const GLuint program, const GLint location, const GLfloat *values,
+                          const GLsizei n_values) {
+  const uint32_t slot = (program * 31u + (uint32_t) location) % UNIFORM_CACHE_SIZE;
+  struct UniformEntry * const entry = &STATE_CACHE.uniforms[slot];
+  if (entry->program == program && entry->location == location && entry->n_values == n_values
+      && memcmp(entry->values, values, sizeof(GLfloat) * n_values) == 0) {
+    STATE_CACHE.current.skipped++;
+    return true;
+  }
+  entry->program = program;
+  entry->location = location;
+  entry->n_values = n_values;
+  memcpy(entry->values, values, sizeof(GLfloat) * n_values);
+  STATE_CACHE.current.issued++;
+  return false;
+}
+
+void xglProgramUniform1f(const GLuint program, const GLint location, const GLfloat value) {
+  if (uniformCached(program, location, &value, 1)) { return; }
+  glProgramUniform1f(program, location, value);
+}
+
+void xglProgramUniform2fv(const GLuint program, const GLint location, const GLfloat value[2]) {
+  if (uniformCached(program, location, value, 2)) { return; }
+  glProgramUniform2fv(program, location, 1, value);
+}
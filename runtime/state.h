@@ -0,0 +1,55 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: state.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_STATE_H
+#define XIDE_STATE_H
+
+#include "glad/glad.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Cache of GL state set by draw functions, so that setting a state to the value
+// it already has is skipped. All draw code should go through these functions;
+// after changing such state with plain GL, call `xglStateInvalidate`.
+// It belongs to the thread of the current GL context.
+
+typedef struct XGLStateStats {
+  uint32_t issued;
+  uint32_t skipped;
+  uint32_t draws;      // draw calls, a multi-draw counts once
+  uint64_t triangles;  // drawn filled, or as lines by polygon mode
+  uint64_t uploaded;   // bytes written to buffers, streamed ones included
+} XGLStateStats;
+
+// Forget all cached state, so that next call of every setter is issued.
+void xglStateInvalidate(void);
+// Start counting for a new frame. Counters of the frame before are kept in `last_frame`.
+void xglStateBeginFrame(void);
+// `current` and `last_frame` may be nullptr.
+void xglStateStats(XGLStateStats *current, XGLStateStats *last_frame);
+// Count a draw call of `count` vertices or indices in primitive `mode`, `n_instances` times.
+void xglCountDraw(GLenum mode, uint64_t count, uint32_t n_instances);
+void xglCountUpload(uint64_t bytes);
+
+void xglUseProgram(GLuint program);
+void xglBindVertexArray(GLuint vao);
+void xglPolygonMode(GLenum mode);
+void xglSetBlend(bool enabled);
+void xglBlendFunc(GLenum src_factor, GLenum dst_factor);
+void xglSetDepthTest(bool enabled);
+void xglDepthMask(bool enabled);
+void xglDepthFunc(GLenum func);
+void xglSetScissor(bool enabled);
+void xglScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+// Bind `XGLViewState` at `offset` of `buffer` to `XGL_VIEW_STATE_BINDING`.
+void xglBindViewBuffer(GLuint buffer, GLintptr offset);
+void xglProgramUniform1f(GLuint program, GLint location, GLfloat value);
+void xglProgramUniform2fv(GLuint program, GLint location, const GLfloat value[2]);
+
+#endif  // XIDE_STATE_H
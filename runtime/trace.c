@@ -0,0 +1,115 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: trace.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "trace.h"
+#include "runtime.h"
+#include <stdio.h>
+
+#ifdef XIDE_TRACE
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct TraceEvent {
+  const char *name;  // nullptr for the end of a zone
+  uint64_t ns;
+} TraceEvent;
+
+typedef struct TraceRing {
+  struct TraceRing *next;
+  const char *thread_name;
+  uint32_t tid;
+  _Atomic uint64_t head;  // number of events ever written
+  TraceEvent events[TRACE_RING_EVENTS];
+} TraceRing;
+
+static _Atomic(TraceRing *) TRACE_RINGS = nullptr;
+static _Atomic uint32_t TRACE_THREADS = 0;
+static _Thread_local TraceRing *THREAD_RING = nullptr;
+
+static uint64_t traceClock(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+// Ring of current thread, registered on first use by a lock-free push. Rings are
+// kept until exit, so that a dump sees threads which have ended.
+static TraceRing *threadRing(void) {
+  if (THREAD_RING) { return THREAD_RING; }
+  TraceRing *ring = calloc(1, sizeof(TraceRing));
+  if (!ring) { return nullptr; }
+  ring->tid = atomic_fetch_add(&TRACE_THREADS, 1) + 1;
+  ring->next = atomic_load(&TRACE_RINGS);
+  while (!atomic_compare_exchange_weak(&TRACE_RINGS, &ring->next, ring)) {}
+  THREAD_RING = ring;
+  return ring;
+}
+
+static void traceEvent(const char * const name) {
+  TraceRing * const ring = threadRing();
+  if (!ring) { return; }
+  const uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  TraceEvent * const event = &ring->events[head % TRACE_RING_EVENTS];
+  event->name = name;
+  event->ns = traceClock();
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+void ideTraceBegin(const char *name) {
+  traceEvent(name);
+}
+
+void ideTraceEnd(void) {
+  traceEvent(nullptr);
+}
+
+void ideTraceThreadName(const char *name) {
+  TraceRing * const ring = threadRing();
+  if (ring) { ring->thread_name = name; }
+}
+
+bool ideTraceDump(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    rt_error("Failed to open trace file: '%s'", path);
+    return false;
+  }
+  fputs("{\"traceEvents\":[\n", file);
+  bool first = true;
+  for (TraceRing *ring = atomic_load(&TRACE_RINGS); ring; ring = ring->next) {
+    if (ring->thread_name) {
+      fprintf(file,
+              "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+              "\"args\":{\"name\":\"%s\"}}",
+              first ? "" : ",\n", ring->tid, ring->thread_name);
+      first = false;
+    }
+    const uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    const uint64_t begin = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+    for (uint64_t i = begin; i < head; i++) {
+      const TraceEvent * const event = &ring->events[i % TRACE_RING_EVENTS];
+      fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+              first ? "" : ",\n", event->name ? event->name : "", event->name ? 'B' : 'E',
+              (double) event->ns * 1e-3, ring->tid);
+      first = false;
+    }
+  }
+  fputs("\n]}\n", file);
+  const bool written = !ferror(file);
+  fclose(file);
+  return written;
+}
+#else
+bool ideTraceDump(const char *path) {
+  rt_warning("Trace '%s' is not written, as tracing is compiled out (XIDE_TRACE)", path);
+  return false;
+}
+#endif
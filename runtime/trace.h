@@ -0,0 +1,56 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: trace.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_TRACE_H
+#define XIDE_TRACE_H
+
+#include <stdbool.h>
+
+// CPU zones for Chrome trace-event JSON, viewable in Perfetto or chrome://tracing.
+// Zones are recorded only when built with `XIDE_TRACE` defined (the CMake option of
+// the same name); otherwise every macro expands to nothing.
+// Each thread writes its own lock-free ring of `TRACE_RING_EVENTS` events, so the
+// oldest events of a thread are overwritten, and no lock is taken while tracing.
+// Zone names must be string literals, as only their address is recorded.
+
+#define TRACE_RING_EVENTS (1 << 16)
+
+#ifdef XIDE_TRACE
+void ideTraceBegin(const char *name);
+void ideTraceEnd(void);
+// Name current thread in the trace.
+void ideTraceThreadName(const char *name);
+
+static inline void ideTraceZoneEnd(const char * const *zone) {
+  (void) zone;
+  ideTraceEnd();
+}
+
+#define TRACE_CONCAT_(_a, _b) _a##_b
+#define TRACE_CONCAT(_a, _b)  TRACE_CONCAT_(_a, _b)
+
+#define TRACE_BEGIN(_name)       ideTraceBegin(_name)
+#define TRACE_END()              ideTraceEnd()
+#define TRACE_THREAD_NAME(_name) ideTraceThreadName(_name)
+// Zone from here to the end of the enclosing block.
+#define TRACE_ZONE(_name)                                             \
+  const char *TRACE_CONCAT(trace_zone_, __LINE__)                      \
+      __attribute__((cleanup(ideTraceZoneEnd))) = (ideTraceBegin(_name), _name)
+#else
+#define TRACE_BEGIN(_name)       ((void) 0)
+#define TRACE_END()              ((void) 0)
+#define TRACE_THREAD_NAME(_name) ((void) 0)
+#define TRACE_ZONE(_name)        ((void) 0)
+#endif
+
+// Write events of all threads to `path`. Threads should have stopped tracing.
+// Return false if the file could not be written, or tracing is compiled out.
+bool ideTraceDump(const char *path);
+
+#endif  // XIDE_TRACE_H
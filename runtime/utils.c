@@ -18,6 +18,18 @@ void rgba2XGLColor(uint32_t rgba, XGLColor *gl_color) {
   (*gl_color)[CAX_A] = (float) ((rgba >> 0x00) & 255) / 255.0f;
 }
 
+void rgba2XGLColor8(uint32_t rgba, XGLColor8 *gl_color) {
+  (*gl_color)[CAX_R] = (GLubyte) ((rgba >> 0x18) & 255);
+  (*gl_color)[CAX_G] = (GLubyte) ((rgba >> 0x10) & 255);
+  (*gl_color)[CAX_B] = (GLubyte) ((rgba >> 0x08) & 255);
+  (*gl_color)[CAX_A] = (GLubyte) ((rgba >> 0x00) & 255);
+}
+
+// Map plane index into NDC depth (-1, 1): the higher the plane, the nearer it is.
+float XGL_planeDepth(int plane_index) {
+  return -atanf((float) plane_index) / (float) M_PI_2;
+}
+
 float XGL_normalize(float *vertex, int dim) {
   float norm = 0;
   for (int i = 0; i < dim; i++) { norm += vertex[i] * vertex[i]; }
@@ -16,5 +16,8 @@
 float XGL_normalize(float *vertex, int dim);
 
 void rgba2XGLColor(uint32_t rgba, XGLColor *gl_color);
+void rgba2XGLColor8(uint32_t rgba, XGLColor8 *gl_color);
+
+float XGL_planeDepth(int plane_index);
 
 #endif  // XIDE_UTILS_H
@@ -0,0 +1,68 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: view.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "view.h"
+#include "damage.h"
+#include "state.h"
+#include <stddef.h>
+
+static GLuint VIEW_STATE_BUFFER = 0;
+// Screen view follows the world view in the buffer, at the uniform buffer offset alignment.
+static GLintptr SCREEN_VIEW_OFFSET = 0;
+static XGLViewState VIEW_STATE = {.zoom = 1.0f};
+
+_Static_assert(sizeof(XGLViewState) == 32, "XGLViewState must match std140 layout of ViewState");
+
+void xglInitViewState(void) {
+  if (VIEW_STATE_BUFFER) { return; }
+  GLint alignment = 256;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  SCREEN_VIEW_OFFSET = ((GLintptr) sizeof(XGLViewState) + alignment - 1) / alignment * alignment;
+  glCreateBuffers(1, &VIEW_STATE_BUFFER);
+  glNamedBufferStorage(VIEW_STATE_BUFFER, SCREEN_VIEW_OFFSET + (GLintptr) sizeof(XGLViewState),
+                       nullptr, GL_DYNAMIC_STORAGE_BIT);
+  glNamedBufferSubData(VIEW_STATE_BUFFER, 0, sizeof(XGLViewState), &VIEW_STATE);
+  glBindBufferBase(GL_UNIFORM_BUFFER, XGL_VIEW_STATE_BINDING, VIEW_STATE_BUFFER);
+}
+
+void xglReleaseViewState(void) {
+  if (!VIEW_STATE_BUFFER) { return; }
+  glDeleteBuffers(1, &VIEW_STATE_BUFFER);
+  VIEW_STATE_BUFFER = 0;
+}
+
+void xglSetViewSize(const GLfloat width, const GLfloat height) {
+  VIEW_STATE.windowSize[0] = width;
+  VIEW_STATE.windowSize[1] = height;
+  xglDamageAll();
+}
+
+void xglSetViewTransform(const GLfloat scroll[2], const GLfloat zoom) {
+  VIEW_STATE.scroll[0] = scroll[0];
+  VIEW_STATE.scroll[1] = scroll[1];
+  VIEW_STATE.zoom = zoom;
+  xglDamageAll();
+}
+
+void xglUploadViewState(const XGLViewState * const view) {
+  XGLViewState screen = *view;
+  screen.scroll[0] = screen.scroll[1] = 0;
+  screen.zoom = 1.0f;
+  glNamedBufferSubData(VIEW_STATE_BUFFER, 0, sizeof(XGLViewState), view);
+  glNamedBufferSubData(VIEW_STATE_BUFFER, SCREEN_VIEW_OFFSET, sizeof(XGLViewState), &screen);
+  xglCountUpload(2 * sizeof(XGLViewState));
+}
+
+void xglUseViewState(const bool screen) {
+  xglBindViewBuffer(VIEW_STATE_BUFFER, screen ? SCREEN_VIEW_OFFSET : 0);
+}
+
+inline const XGLViewState *xglGetViewState(void) {
+  return &VIEW_STATE;
+}
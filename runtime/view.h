@@ -0,0 +1,46 @@
+/**
+ * Project Name: xide
+ * Module Name: runtime
+ * Filename: view.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_VIEW_H
+#define XIDE_VIEW_H
+
+#include "glad/glad.h"
+#include <stdbool.h>
+
+// Binding point of the `ViewState` uniform block read by all built-in shaders:
+//   layout (std140, binding = 0) uniform ViewState {
+//       vec2 windowSize; vec2 scroll; float zoom; float time;
+//   };
+#define XGL_VIEW_STATE_BINDING 0
+
+// Mirror of `ViewState` in std140 layout.
+typedef struct XGLViewState {
+  GLfloat windowSize[2];
+  GLfloat scroll[2];
+  GLfloat zoom;
+  GLfloat time;
+  GLfloat padding[2];
+} XGLViewState;
+
+// Create uniform buffer of the current GL context, and bind it to `XGL_VIEW_STATE_BINDING`.
+void xglInitViewState(void);
+void xglReleaseViewState(void);
+// Changing view size or transform damages the whole window.
+void xglSetViewSize(GLfloat width, GLfloat height);
+// Vertices are drawn at `(position - scroll) * zoom` in pixels.
+void xglSetViewTransform(const GLfloat scroll[2], GLfloat zoom);
+// Upload `view` for a new frame, on the GL thread. The UI thread sets view state
+// and a copy of it is published with each frame.
+void xglUploadViewState(const XGLViewState *view);
+// Bind the uploaded view, or with `screen` the same view without scroll and zoom, so
+// that vertices are in window pixels.
+void xglUseViewState(bool screen);
+const XGLViewState *xglGetViewState(void);
+
+#endif  // XIDE_VIEW_H
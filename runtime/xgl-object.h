@@ -17,7 +17,13 @@ enum LOCATION_LAYER {
   LOC_VERTEX = 0,
   LOC_COLOR = 1,
   LOC_TEXTURE = 2,
-  LOC_WINDOW_SIZE = 3,
+  LOC_PLANE_DEPTH = 4,
+  // per-instance attributes of `XGLRect`
+  LOC_RECT = 5,
+  LOC_RADII = 6,
+  LOC_BORDER_WIDTH = 7,
+  LOC_FILL_COLOR = 8,
+  LOC_BORDER_COLOR = 9,
 };
 
 typedef GLuint iXGLVao;
@@ -27,8 +33,28 @@ typedef GLuint iXGLshProg;
 
 typedef GLfloat XGLCoord[4];
 typedef GLfloat XGLColor[4];
+typedef GLubyte XGLColor8[4];
 typedef GLfloat Matrix[4][4];
 
+// Interleaved vertex of draw tasks: 2D position and RGBA8 colour normalized by GL.
+// Depth is the same for every vertex of a task, so it is a uniform instead.
+typedef struct XGLVertex {
+  GLfloat coord[2];
+  XGLColor8 color;
+} XGLVertex;
+
+// Instance of the rectangle primitive, a unit quad shaded by a rounded box SDF.
+// Rect is in pixels; radii are in pixels, clockwise from top-left corner.
+typedef struct XGLRect {
+  GLfloat rect[4];  // x, y, width, height
+  GLubyte radii[4];
+  GLfloat border_width;
+  XGLColor8 fill;
+  XGLColor8 border;
+} XGLRect;
+
+_Static_assert(sizeof(XGLRect) == 32, "XGLRect must be 32 bytes");
+
 enum UNIFORM_DATA_TYPE {
   UD_INT,
   UD_UINT,
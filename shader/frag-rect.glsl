@@ -0,0 +1,37 @@
+#version 460 core
+in vec2 vsLocal;
+flat in vec2 vsHalfSize;
+flat in vec4 vsRadii;
+flat in float vsBorderWidth;
+flat in vec4 vsFill;
+flat in vec4 vsBorder;
+out vec4 FragColor;
+
+// Signed distance from `p` to a box of `halfSize` centered at origin, whose corner
+// radii are clockwise from top-left. Y goes down, as in window coordinates.
+float roundedBox(vec2 p, vec2 halfSize, vec4 radii)
+{
+    float radius = p.x > 0.0f ? (p.y > 0.0f ? radii.z : radii.y)
+                              : (p.y > 0.0f ? radii.w : radii.x);
+    radius = min(radius, min(halfSize.x, halfSize.y));
+    vec2 q = abs(p) - halfSize + radius;
+    return min(max(q.x, q.y), 0.0f) + length(max(q, 0.0f)) - radius;
+}
+
+void main()
+{
+    float distance = roundedBox(vsLocal, vsHalfSize, vsRadii);
+#ifdef XGL_VARIANT_AA
+    // Fade edges over one pixel.
+    float aa = fwidth(distance) * 0.5f;
+    float outside = smoothstep(-aa, aa, distance);
+    float inBorder = vsBorderWidth > 0.0f ? smoothstep(-aa, aa, distance + vsBorderWidth) : 0.0f;
+#else
+    float outside = step(0.0f, distance);
+    float inBorder = vsBorderWidth > 0.0f ? step(0.0f, distance + vsBorderWidth) : 0.0f;
+#endif
+    vec4 color = mix(vsFill, vsBorder, inBorder);
+    color.a *= 1.0f - outside;
+    if (color.a <= 0.0f) discard;
+    FragColor = color;
+}
@@ -1,13 +1,19 @@
 #version 460 core
-layout (location = 0) in vec4 aPos;
+layout (location = 0) in vec2 aPos;
 layout (location = 1) in vec4 aCol;
-layout (location = 3) uniform vec2 windowSize;
+layout (location = 4) uniform float planeDepth;
+layout (std140, binding = 0) uniform ViewState {
+    vec2 windowSize;
+    vec2 scroll;
+    float zoom;
+    float time;
+};
 out vec4 vsColor;
 
 void main()
 {
-    vec2 ndcPosition = (aPos.xy / windowSize) * 2.0f - 1.0f;
+    vec2 ndcPosition = ((aPos - scroll) * zoom / windowSize) * 2.0f - 1.0f;
     ndcPosition.y = -ndcPosition.y;
-    gl_Position = vec4(ndcPosition, aPos.z, 1.0f);
+    gl_Position = vec4(ndcPosition, planeDepth, 1.0f);
     vsColor = aCol;
 }
@@ -0,0 +1,40 @@
+#version 460 core
+#ifndef XGL_VARIANT_INSTANCED
+#error "vert-rect.glsl reads one rect per instance, link it as SV_INSTANCED"
+#endif
+layout (location = 0) in vec2 aCorner;
+layout (location = 5) in vec4 aRect;
+layout (location = 6) in vec4 aRadii;
+layout (location = 7) in float aBorderWidth;
+layout (location = 8) in vec4 aFill;
+layout (location = 9) in vec4 aBorder;
+layout (location = 4) uniform float planeDepth;
+layout (std140, binding = 0) uniform ViewState {
+    vec2 windowSize;
+    vec2 scroll;
+    float zoom;
+    float time;
+};
+out vec2 vsLocal;
+flat out vec2 vsHalfSize;
+flat out vec4 vsRadii;
+flat out float vsBorderWidth;
+flat out vec4 vsFill;
+flat out vec4 vsBorder;
+
+void main()
+{
+    // Grow quad by one screen pixel, so the anti-aliased edge is not cut off.
+    vec2 halfSize = aRect.zw * 0.5f;
+    vec2 local = (aCorner * 2.0f - 1.0f) * (halfSize + 1.0f / zoom);
+    vec2 position = aRect.xy + halfSize + local;
+    vec2 ndcPosition = ((position - scroll) * zoom / windowSize) * 2.0f - 1.0f;
+    ndcPosition.y = -ndcPosition.y;
+    gl_Position = vec4(ndcPosition, planeDepth, 1.0f);
+    vsLocal = local;
+    vsHalfSize = halfSize;
+    vsRadii = aRadii;
+    vsBorderWidth = aBorderWidth;
+    vsFill = aFill;
+    vsBorder = aBorder;
+}
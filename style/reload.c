@@ -0,0 +1,255 @@
+/**
+ * Project Name: xide
+ * Module Name: style
+ * Filename: reload.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "reload.h"
+#include "ring.h"
+#include "shader.h"
+#include "state.h"
+#include "trace.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef __linux__
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+typedef struct WatchedProgram {
+  GLuint program;  // latest build
+  const char *names[2];
+  uint32_t variant;
+} WatchedProgram;
+
+// Replaced program, deleted once tasks are switched from it and frame `frame`, the last
+// which may draw it, is completed.
+typedef struct RetiredProgram {
+  GLuint program;
+  uint64_t frame;
+  bool switched;
+} RetiredProgram;
+
+typedef struct ProgramSwap {
+  GLuint old_program;
+  GLuint new_program;
+} ProgramSwap;
+
+// Watched program `index` being relinked.
+typedef struct ProgramRelink {
+  uint32_t index;
+} ProgramRelink;
+
+static struct {
+  pthread_mutex_t lock;  // guards programs and retired ones
+  WatchedProgram programs[SHADER_WATCHED_PROGRAMS];
+  uint32_t n_programs;
+  RetiredProgram retired[SHADER_RETIRED_PROGRAMS];
+  uint32_t n_retired;
+  IdeWindow *window;
+  const char *dir;
+  bool watching;
+  _Atomic bool quit;
+  int fd;
+  int wd;
+  pthread_t thread;
+} RELOAD = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+void ideWatchProgram(const GLuint program, const char *vertex_name, const char *fragment_name,
+                     const uint32_t variant) {
+  pthread_mutex_lock(&RELOAD.lock);
+  if (RELOAD.n_programs < SHADER_WATCHED_PROGRAMS) {
+    RELOAD.programs[RELOAD.n_programs++] = (WatchedProgram) {
+      program, {vertex_name, fragment_name}, variant
+    };
+  } else {
+    rt_warning("Too many watched programs, '%s' is not reloaded", fragment_name);
+  }
+  pthread_mutex_unlock(&RELOAD.lock);
+}
+
+static bool usesFile(const WatchedProgram * const watched, const char * const name) {
+  return strcmp(watched->names[0], name) == 0 || strcmp(watched->names[1], name) == 0;
+}
+
+// Runs on the UI thread, which owns the task list.
+static void swapProgram(IdeWindow *window, void *arg) {
+  ProgramSwap * const swap = arg;
+  const uint32_t n_tasks = Array_length(window->drawTaskList);
+  DrawTask * const tasks = Array_get(window->drawTaskList, 0);
+  for (uint32_t i = 0; i < n_tasks; i++) {
+    if (tasks[i].program == swap->old_program) { tasks[i].program = swap->new_program; }
+  }
+  window->drawTaskVersion++;
+  xglDamageAll();
+  // Frames published from now on draw the new program.
+  const uint64_t frame = xglGetStreamRing()->published;
+  pthread_mutex_lock(&RELOAD.lock);
+  for (uint32_t i = 0; i < RELOAD.n_retired; i++) {
+    if (RELOAD.retired[i].program != swap->old_program) { continue; }
+    RELOAD.retired[i].frame = frame;
+    RELOAD.retired[i].switched = true;
+  }
+  pthread_mutex_unlock(&RELOAD.lock);
+  window->allocator->free(swap);
+}
+
+// Frame hook deleting retired programs which no frame in flight draws any more.
+static void deleteRetired(void *arg) {
+  (void) arg;
+  const uint64_t completed = xglGetStreamRing()->completed;
+  bool deleted = false;
+  pthread_mutex_lock(&RELOAD.lock);
+  for (uint32_t i = 0; i < RELOAD.n_retired;) {
+    const RetiredProgram retired = RELOAD.retired[i];
+    if (!retired.switched || retired.frame > completed) {
+      i++;
+      continue;
+    }
+    glDeleteProgram(retired.program);
+    deleted = true;
+    RELOAD.retired[i] = RELOAD.retired[--RELOAD.n_retired];
+  }
+  pthread_mutex_unlock(&RELOAD.lock);
+  // Names of deleted programs may be handed out again, so cached bindings are stale.
+  if (deleted) { xglStateInvalidate(); }
+}
+
+// Called on the render thread once a relink has completed, with 0 if it failed.
+static void programRelinked(const GLuint program, void *arg) {
+  ProgramRelink * const relink = arg;
+  IdeWindow * const window = RELOAD.window;
+  pthread_mutex_lock(&RELOAD.lock);
+  WatchedProgram * const watched = &RELOAD.programs[relink->index];
+  const GLuint old_program = watched->program;
+  const char * const name = watched->names[1];
+  if (program) {
+    watched->program = program;
+    if (RELOAD.n_retired < SHADER_RETIRED_PROGRAMS) {
+      RELOAD.retired[RELOAD.n_retired++] = (RetiredProgram) {old_program, 0, false};
+    }
+  }
+  pthread_mutex_unlock(&RELOAD.lock);
+  window->allocator->free(relink);
+  if (!program) {
+    rt_warning("Shader '%s' failed to reload, program %u is kept", name, old_program);
+    return;
+  }
+  ProgramSwap * const swap = window->allocator->malloc(sizeof(ProgramSwap));
+  *swap = (ProgramSwap) {old_program, program};
+  ideUiCall(window, swapProgram, swap);
+  rt_message("Reloaded shader '%s' into program %u", name, program);
+}
+
+// Render thread job of shader file `arg` having changed. Programs using it are compiled
+// and linked in the background, so frames go on drawing the old ones meanwhile.
+static void reloadFile(void *arg) {
+  TRACE_ZONE("reloadShader");
+  char * const name = arg;
+  IdeWindow * const window = RELOAD.window;
+  for (uint32_t i = 0;; i++) {
+    pthread_mutex_lock(&RELOAD.lock);
+    const bool end = i >= RELOAD.n_programs;
+    const WatchedProgram watched = end ? (WatchedProgram) {} : RELOAD.programs[i];
+    pthread_mutex_unlock(&RELOAD.lock);
+    if (end) { break; }
+    if (!usesFile(&watched, name)) { continue; }
+
+    ProgramRelink * const relink = window->allocator->malloc(sizeof(ProgramRelink));
+    relink->index = i;
+    if (!relinkEmbeddedProgram(RELOAD.dir, watched.names[0], watched.names[1], watched.variant,
+                               programRelinked, relink, window->allocator)) {
+      rt_warning("Shader '%s' failed to reload, program %u is kept", name, watched.program);
+      window->allocator->free(relink);
+    }
+  }
+  window->allocator->free(name);
+}
+
+#ifdef __linux__
+
+static bool watchedFile(const char * const name) {
+  bool used = false;
+  pthread_mutex_lock(&RELOAD.lock);
+  for (uint32_t i = 0; i < RELOAD.n_programs && !used; i++) {
+    used = usesFile(&RELOAD.programs[i], name);
+  }
+  pthread_mutex_unlock(&RELOAD.lock);
+  return used;
+}
+
+static void *watchMain(void *arg) {
+  TRACE_THREAD_NAME("shader-watch");
+  const Allocator * const allocator = RELOAD.window->allocator;
+  char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  while (!atomic_load(&RELOAD.quit)) {
+    const ssize_t length = read(RELOAD.fd, buffer, sizeof(buffer));
+    if (length < 0 && errno == EINTR) { continue; }
+    if (length <= 0) { break; }
+    for (const char *p = buffer; p < buffer + length;) {
+      const struct inotify_event * const event = (const struct inotify_event *) p;
+      p += sizeof(struct inotify_event) + event->len;
+      // Editors either write a file in place or move a new one over it.
+      if (!event->len || !(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) { continue; }
+      if (atomic_load(&RELOAD.quit) || !watchedFile(event->name)) { continue; }
+      const size_t size = strlen(event->name) + 1;
+      char * const name = allocator->malloc(size);
+      memcpy(name, event->name, size);
+      ideRenderCall(RELOAD.window, reloadFile, name);
+    }
+  }
+  return nullptr;
+}
+
+bool ideWatchShaders(IdeWindow *window, const char *dir) {
+  if (RELOAD.watching) { return true; }
+  RELOAD.fd = inotify_init1(IN_CLOEXEC);
+  if (RELOAD.fd < 0) {
+    rt_warning("Failed to watch shaders in '%s': %s", dir, strerror(errno));
+    return false;
+  }
+  RELOAD.wd = inotify_add_watch(RELOAD.fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+  if (RELOAD.wd < 0) {
+    rt_warning("Failed to watch shaders in '%s': %s", dir, strerror(errno));
+    close(RELOAD.fd);
+    return false;
+  }
+  RELOAD.window = window;
+  RELOAD.dir = dir;
+  ideAddFrameHook(window, deleteRetired, nullptr);
+  atomic_store(&RELOAD.quit, false);
+  pthread_create(&RELOAD.thread, nullptr, watchMain, nullptr);
+  RELOAD.watching = true;
+  return true;
+}
+
+void ideUnwatchShaders(void) {
+  if (!RELOAD.watching) { return; }
+  atomic_store(&RELOAD.quit, true);
+  // Removing the watch queues an `IN_IGNORED` event, which wakes the blocked read.
+  inotify_rm_watch(RELOAD.fd, RELOAD.wd);
+  pthread_join(RELOAD.thread, nullptr);
+  close(RELOAD.fd);
+  ideRemoveFrameHook(RELOAD.window, deleteRetired, nullptr);
+  RELOAD.watching = false;
+}
+
+#else
+
+bool ideWatchShaders(IdeWindow *window, const char *dir) {
+  (void) window;
+  (void) reloadFile;
+  (void) deleteRetired;
+  rt_warning("Shader hot reload needs inotify, '%s' is not watched", dir);
+  return false;
+}
+
+void ideUnwatchShaders(void) {}
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * Project Name: xide
+ * Module Name: style
+ * Filename: reload.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-19
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef XIDE_RELOAD_H
+#define XIDE_RELOAD_H
+
+#include "runtime.h"
+
+// Hot reload of built-in shaders while shader/ is being edited. A watcher thread waits on
+// inotify for shader files written or moved into the directory, and the render thread
+// rebuilds every watched program using such a file from disk, compiling in the background
+// where parallel shader compile is supported. Once built, tasks of the old program are
+// switched to the new one on the UI thread, and the old program is deleted by the render
+// thread after the first frame completed once no frame in flight draws it. When the new
+// program fails to build, it is reported and the old one is kept.
+// Watching needs inotify, so it only works on Linux.
+
+#define SHADER_WATCHED_PROGRAMS 32
+// Replaced programs waiting for frames in flight, more are never deleted.
+#define SHADER_RETIRED_PROGRAMS 32
+
+// Rebuild `program` of embedded shaders as `variant` whenever one of their files changes.
+void ideWatchProgram(GLuint program, const char *vertex_name, const char *fragment_name,
+                     uint32_t variant);
+// Start watching `dir` for programs of `window`, once its render thread is running.
+// Return false if the directory cannot be watched.
+bool ideWatchShaders(IdeWindow *window, const char *dir);
+// Stop watching, before the render thread stops.
+void ideUnwatchShaders(void);
+
+#endif  // XIDE_RELOAD_H
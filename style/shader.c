@@ -8,30 +8,378 @@
  **/
 
 #include "shader.h"
+#include "program.h"
 #include "runtime.h"
+#include "trace.h"
+#include <errno.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
 
-GLuint compileShader(char *path, GLenum type, const Allocator *allocator) {
+#ifndef _WIN32
+static int fopen_s(FILE **file, const char *path, const char *mode) {
+  *file = fopen(path, mode);
+  return *file ? 0 : errno;
+}
+#endif
+
+#define FNV_OFFSET 0xCBF29CE484222325ull
+#define FNV_PRIME  0x100000001B3ull
+// "XPB1", header of cache files.
+#define PROGRAM_CACHE_MAGIC 0x31425058u
+
+typedef struct ProgramCacheHeader {
+  uint32_t magic;
+  GLenum format;
+  uint64_t key;
+  uint32_t length;
+} ProgramCacheHeader;
+
+// Source of a shader, as strings passed to `glShaderSource` in order.
+typedef struct ShaderSource {
+  const char *name;
+  const GLchar *strings[3];
+  GLint lengths[3];  // negative for a NUL-terminated string
+  GLsizei n_strings;
+} ShaderSource;
+
+static const char *PROGRAM_CACHE_DIR = nullptr;
+
+static GLchar *readSource(const char * const path, const Allocator * const allocator) {
   FILE *file = NULL;
-  if (fopen_s(&file, path, "r") != 0) {
+  if (fopen_s(&file, path, "rb") != 0) {
     rt_error("Failed to open shader file: '%s'", path);
-    return 0;
+    return nullptr;
   }
   fseek(file, 0, SEEK_END);
   long length = ftell(file);
   fseek(file, 0, SEEK_SET);
   GLchar *source = allocator->malloc((sizeof(char) * length) + 1);
-  fread((void *) source, sizeof(char), length, file);
+  length = (long) fread((void *) source, sizeof(char), length, file);
   source[length] = 0;
+  fclose(file);
+  return source;
+}
+
+static GLuint compileSource(const ShaderSource * const source, const GLenum type) {
+  TRACE_ZONE("compileShader");
   GLuint shader = glCreateShader(type);
-  glShaderSource(shader, 1, (const GLchar **) &source, NULL);
+  glShaderSource(shader, source->n_strings, source->strings, source->lengths);
   glCompileShader(shader);
+  return shader;
+}
+
+// Querying status blocks until compile completes, so it is done apart from compiling.
+static void reportShader(const GLuint shader, const char * const name) {
   int success;
   char infoLog[512];
   glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
   if (!success) {
     glGetShaderInfoLog(shader, 512, NULL, infoLog);
-    rt_error("Failed to compile shader '%s': \n%s\n", path, infoLog);
+    rt_error("Failed to compile shader '%s': \n%s\n", name, infoLog);
   }
+}
+
+GLuint compileShader(char *path, GLenum type, const Allocator *allocator) {
+  GLchar *text = readSource(path, allocator);
+  if (!text) { return 0; }
+  const ShaderSource source = {path, {text}, {-1}, 1};
+  const GLuint shader = compileSource(&source, type);
+  reportShader(shader, path);
+  allocator->free(text);
   return shader;
 }
+
+// Source of embedded shader `name` with defines of `variant` after its `#version`.
+static bool embeddedSource(const char * const name, const uint32_t variant,
+                           ShaderSource * const source) {
+  for (uint32_t i = 0; i < N_EMBEDDED_SHADERS; i++) {
+    const EmbeddedShader * const shader = &EMBEDDED_SHADERS[i];
+    if (strcmp(shader->name, name) != 0) { continue; }
+    source->name = shader->name;
+    source->strings[0] = shader->version;
+    source->strings[1] = SHADER_VARIANT_DEFINES[variant % SHADER_VARIANTS];
+    source->strings[2] = shader->body;
+    source->lengths[0] = source->lengths[1] = source->lengths[2] = -1;
+    source->n_strings = 3;
+    return true;
+  }
+  rt_error("No embedded shader '%s'", name);
+  return false;
+}
+
+GLuint compileEmbeddedShader(const char *name, GLenum type, uint32_t variant) {
+  ShaderSource source;
+  if (!embeddedSource(name, variant, &source)) { return 0; }
+  const GLuint shader = compileSource(&source, type);
+  reportShader(shader, name);
+  return shader;
+}
+
+// Hash `length` bytes of `string`, or up to its NUL if `length` is negative.
+static uint64_t fnv1a(uint64_t hash, const char *string, const GLint length) {
+  for (GLint i = 0; string && (length < 0 ? string[i] != 0 : i < length); i++) {
+    hash ^= (uint8_t) string[i];
+    hash *= FNV_PRIME;
+  }
+  // Separate strings, so that moving text from one to the next changes the hash.
+  hash ^= 0xFF;
+  return hash * FNV_PRIME;
+}
+
+// Key of a program: its sources and the driver, which binaries are only valid for.
+static uint64_t programKey(const ShaderSource *vertex, const ShaderSource *fragment) {
+  uint64_t key = FNV_OFFSET;
+  for (GLsizei i = 0; i < vertex->n_strings; i++) {
+    key = fnv1a(key, vertex->strings[i], vertex->lengths[i]);
+  }
+  for (GLsizei i = 0; i < fragment->n_strings; i++) {
+    key = fnv1a(key, fragment->strings[i], fragment->lengths[i]);
+  }
+  key = fnv1a(key, (const char *) glGetString(GL_VENDOR), -1);
+  key = fnv1a(key, (const char *) glGetString(GL_RENDERER), -1);
+  key = fnv1a(key, (const char *) glGetString(GL_VERSION), -1);
+  return key;
+}
+
+static void cachePath(const uint64_t key, char path[], const size_t size) {
+  snprintf(path, size, "%s/%016llx.bin", PROGRAM_CACHE_DIR, (unsigned long long) key);
+}
+
+static bool linked(const GLuint program) {
+  GLint status = 0;
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  return status;
+}
+
+// Program from cached binary of `key`, or 0 if there is none or driver rejects it.
+static GLuint loadCachedProgram(const uint64_t key, const Allocator * const allocator) {
+  char path[512];
+  cachePath(key, path, sizeof(path));
+  FILE *file = NULL;
+  if (fopen_s(&file, path, "rb") != 0) { return 0; }
+  ProgramCacheHeader header;
+  GLuint program = 0;
+  if (fread(&header, sizeof(header), 1, file) == 1 && header.magic == PROGRAM_CACHE_MAGIC
+      && header.key == key && header.length) {
+    void *binary = allocator->malloc(header.length);
+    if (fread(binary, 1, header.length, file) == header.length) {
+      program = glCreateProgram();
+      glProgramBinary(program, header.format, binary, (GLsizei) header.length);
+      if (!linked(program)) {
+        glDeleteProgram(program);
+        program = 0;
+      }
+    }
+    allocator->free(binary);
+  }
+  fclose(file);
+  return program;
+}
+
+static void makeCacheDir(void) {
+#ifdef _WIN32
+  _mkdir(PROGRAM_CACHE_DIR);
+#else
+  mkdir(PROGRAM_CACHE_DIR, 0755);
+#endif
+}
+
+static void saveCachedProgram(const GLuint program, const uint64_t key,
+                              const Allocator * const allocator) {
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) { return; }
+  ProgramCacheHeader header = {.magic = PROGRAM_CACHE_MAGIC, .key = key};
+  void *binary = allocator->malloc(length);
+  GLsizei written = 0;
+  glGetProgramBinary(program, length, &written, &header.format, binary);
+  header.length = (uint32_t) written;
+
+  makeCacheDir();
+  char path[512], temp[544];
+  cachePath(key, path, sizeof(path));
+  // Written aside and renamed into place, so that another process never loads half a file.
+  snprintf(temp, sizeof(temp), "%s.%d.tmp", path, (int) getpid());
+  FILE *file = NULL;
+  if (written > 0 && fopen_s(&file, temp, "wb") == 0) {
+    bool complete = fwrite(&header, sizeof(header), 1, file) == 1
+                    && fwrite(binary, 1, written, file) == (size_t) written;
+    complete = fclose(file) == 0 && complete;
+#ifdef _WIN32
+    // `rename` does not replace an existing file on Windows.
+    if (complete) { remove(path); }
+#endif
+    if (!complete || rename(temp, path) != 0) { remove(temp); }
+  }
+  allocator->free(binary);
+}
+
+void setProgramCacheDir(const char *dir) {
+  PROGRAM_CACHE_DIR = dir;
+}
+
+// Shaders of a program being built, released once its link has completed.
+typedef struct ProgramBuild {
+  const char *names[2];
+  GLuint shaders[2];
+  uint64_t key;
+  bool cached;
+  XGLProgramReadyFn relinked;  // of `relinkEmbeddedProgram`, nullptr for other builds
+  void *arg;
+  const Allocator *allocator;
+} ProgramBuild;
+
+// Program of `vertex` and `fragment` from the program binary cache, with no shaders in
+// `build`, or else one just submitted to compile and link, which `finishBuild` completes.
+// Without `cache`, the cache is neither read nor written.
+static GLuint startBuild(const ShaderSource * const vertex, const ShaderSource * const fragment,
+                         const bool cache, ProgramBuild * const build) {
+  GLint n_formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+  build->cached = cache && PROGRAM_CACHE_DIR && n_formats > 0;
+  build->key = build->cached ? programKey(vertex, fragment) : 0;
+  build->shaders[0] = build->shaders[1] = 0;
+  GLuint program = build->cached ? loadCachedProgram(build->key, build->allocator) : 0;
+  if (program) { return program; }
+
+  build->names[0] = vertex->name;
+  build->names[1] = fragment->name;
+  build->shaders[0] = compileSource(vertex, GL_VERTEX_SHADER);
+  build->shaders[1] = compileSource(fragment, GL_FRAGMENT_SHADER);
+  program = glCreateProgram();
+  if (build->cached) { glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); }
+  glAttachShader(program, build->shaders[0]);
+  glAttachShader(program, build->shaders[1]);
+  glLinkProgram(program);
+  return program;
+}
+
+// Report errors of `program`, cache it if it linked, and release its shaders.
+// Return false if it failed to link.
+static bool finishBuild(const GLuint program, const ProgramBuild * const build) {
+  reportShader(build->shaders[0], build->names[0]);
+  reportShader(build->shaders[1], build->names[1]);
+  const bool success = linked(program);
+  if (!success) {
+    GLchar infoLog[512];
+    glGetProgramInfoLog(program, 512, NULL, infoLog);
+    rt_error("Failed to link shader program: \n%s", infoLog);
+  } else if (build->cached) {
+    saveCachedProgram(program, build->key, build->allocator);
+  }
+  for (uint32_t i = 0; i < 2; i++) {
+    glDetachShader(program, build->shaders[i]);
+    glDeleteShader(build->shaders[i]);
+  }
+  return success;
+}
+
+static void finishAsyncBuild(const GLuint program, void *arg) {
+  ProgramBuild * const build = arg;
+  const bool success = finishBuild(program, build);
+  if (build->relinked) {
+    if (!success) { glDeleteProgram(program); }
+    build->relinked(success ? program : 0, build->arg);
+  }
+  build->allocator->free(build);
+}
+
+static GLuint buildProgram(const ShaderSource * const vertex, const ShaderSource * const fragment,
+                           const Allocator * const allocator) {
+  ProgramBuild build = {.allocator = allocator};
+  const GLuint program = startBuild(vertex, fragment, true, &build);
+  if (build.shaders[0]) { finishBuild(program, &build); }
+  return program;
+}
+
+GLuint linkProgram(const char *vertex_path, const char *fragment_path,
+                   const Allocator *allocator) {
+  GLchar *vertex_text = readSource(vertex_path, allocator);
+  GLchar *fragment_text = readSource(fragment_path, allocator);
+  GLuint program = 0;
+  if (vertex_text && fragment_text) {
+    const ShaderSource vertex = {vertex_path, {vertex_text}, {-1}, 1};
+    const ShaderSource fragment = {fragment_path, {fragment_text}, {-1}, 1};
+    program = buildProgram(&vertex, &fragment, allocator);
+  }
+  allocator->free(vertex_text);
+  allocator->free(fragment_text);
+  return program;
+}
+
+GLuint linkEmbeddedProgram(const char *vertex_name, const char *fragment_name, uint32_t variant,
+                           const Allocator *allocator) {
+  ShaderSource vertex, fragment;
+  if (!embeddedSource(vertex_name, variant, &vertex)
+      || !embeddedSource(fragment_name, variant, &fragment)) {
+    return 0;
+  }
+  return buildProgram(&vertex, &fragment, allocator);
+}
+
+GLuint linkEmbeddedProgramAsync(const char *vertex_name, const char *fragment_name,
+                                uint32_t variant, const Allocator *allocator) {
+  ShaderSource vertex, fragment;
+  if (!embeddedSource(vertex_name, variant, &vertex)
+      || !embeddedSource(fragment_name, variant, &fragment)) {
+    return 0;
+  }
+  ProgramBuild * const build = allocator->malloc(sizeof(ProgramBuild));
+  *build = (ProgramBuild) {.allocator = allocator};
+  const GLuint program = startBuild(&vertex, &fragment, true, build);
+  if (!build->shaders[0]) {
+    allocator->free(build);
+    return program;
+  }
+  xglAwaitProgram(program, finishAsyncBuild, build);
+  return program;
+}
+
+// Source of shader file `text` as `variant`, split as cmake/embed-shaders.cmake does:
+// its `#version` line is passed by length out of `text`, and the rest after it.
+static void fileSource(const char * const name, const char * const text, const uint32_t variant,
+                       ShaderSource * const source) {
+  const char *body = text;
+  const char * const line_end = strchr(text, '\n');
+  if (strncmp(text, "#version", 8) == 0 && line_end) { body = line_end + 1; }
+  source->name = name;
+  source->strings[0] = text;
+  source->strings[1] = SHADER_VARIANT_DEFINES[variant % SHADER_VARIANTS];
+  source->strings[2] = body;
+  source->lengths[0] = (GLint) (body - text);
+  source->lengths[1] = source->lengths[2] = -1;
+  source->n_strings = 3;
+}
+
+bool relinkEmbeddedProgram(const char *dir, const char *vertex_name, const char *fragment_name,
+                           uint32_t variant, XGLProgramReadyFn fn, void *arg,
+                           const Allocator *allocator) {
+  char paths[2][512];
+  snprintf(paths[0], sizeof(paths[0]), "%s/%s", dir, vertex_name);
+  snprintf(paths[1], sizeof(paths[1]), "%s/%s", dir, fragment_name);
+  GLchar *vertex_text = readSource(paths[0], allocator);
+  GLchar *fragment_text = readSource(paths[1], allocator);
+  const bool started = vertex_text && fragment_text;
+  if (started) {
+    ShaderSource vertex, fragment;
+    fileSource(vertex_name, vertex_text, variant, &vertex);
+    fileSource(fragment_name, fragment_text, variant, &fragment);
+    ProgramBuild * const build = allocator->malloc(sizeof(ProgramBuild));
+    *build = (ProgramBuild) {.relinked = fn, .arg = arg, .allocator = allocator};
+    // Every edit would leave a binary behind which is never loaded again.
+    const GLuint program = startBuild(&vertex, &fragment, false, build);
+    xglAwaitProgram(program, finishAsyncBuild, build);
+  }
+  allocator->free(vertex_text);
+  allocator->free(fragment_text);
+  return started;
+}
@@ -12,7 +12,60 @@
 
 #include "allocator.h"
 #include "glad/glad.h"
+#include "program.h"
+#include <stdbool.h>
+#include <stdint.h>
 
+// Files of shader/ are embedded into the binary at build time by
+// cmake/embed-shaders.cmake, so built-in shaders are looked up with no file I/O.
+// A variant inserts `#define`s of its flags right after the `#version` line.
+enum SHADER_VARIANT {
+  SV_AA = 1 << 0,         // XGL_VARIANT_AA, analytic anti-aliasing
+  SV_INSTANCED = 1 << 1,  // XGL_VARIANT_INSTANCED
+};
+#define SHADER_VARIANTS 4
+
+typedef struct EmbeddedShader {
+  const char *name;     // file name in shader/
+  const char *version;  // `#version` line, or empty
+  const char *body;     // rest of the source
+} EmbeddedShader;
+
+extern const EmbeddedShader EMBEDDED_SHADERS[];
+extern const uint32_t N_EMBEDDED_SHADERS;
+// Defines of every combination of `enum SHADER_VARIANT` flags.
+extern const char * const SHADER_VARIANT_DEFINES[SHADER_VARIANTS];
+
+// Compile shader file at `path`, read at runtime.
 GLuint compileShader(char *path, GLenum type, const Allocator *allocator);
+// Compile embedded shader `name`, e.g. "vert-default.glsl", as `variant`.
+// Return 0 if there is no such shader.
+GLuint compileEmbeddedShader(const char *name, GLenum type, uint32_t variant);
+
+// Directory of the program binary cache, created on first save; nullptr disables it.
+// Binaries are keyed by a hash of the sources and GL vendor, renderer and version.
+void setProgramCacheDir(const char *dir);
+// Program of the vertex and fragment shader at given paths, loaded from the program
+// binary cache if it holds a binary the driver accepts, or compiled, linked and then
+// cached otherwise. Link errors are reported, and the program is returned anyway.
+// Return 0 if a shader file could not be read.
+GLuint linkProgram(const char *vertex_path, const char *fragment_path,
+                   const Allocator *allocator);
+// Same as `linkProgram`, of embedded shaders as `variant`.
+GLuint linkEmbeddedProgram(const char *vertex_name, const char *fragment_name, uint32_t variant,
+                           const Allocator *allocator);
+// Same as `linkEmbeddedProgram`, but returns before compile and link complete when the
+// driver supports parallel shader compile. The program can be used by tasks at once;
+// they are drawn from the frame after it is ready on (see runtime/program.h).
+GLuint linkEmbeddedProgramAsync(const char *vertex_name, const char *fragment_name,
+                                uint32_t variant, const Allocator *allocator);
+// Build a program of embedded shaders anew from their files in `dir`, e.g. shader/ while
+// it is being edited, bypassing the program binary cache. Compile and link run as those
+// of `linkEmbeddedProgramAsync`; `fn` is then called on the GL thread with the program,
+// or with 0 if it failed to build. Return false if a file could not be read, and `fn`
+// is not called.
+bool relinkEmbeddedProgram(const char *dir, const char *vertex_name, const char *fragment_name,
+                           uint32_t variant, XGLProgramReadyFn fn, void *arg,
+                           const Allocator *allocator);
 
 #endif  // XIDE_SHADER_H